@@ -0,0 +1,52 @@
+#ifndef FANGPP_BOARD_FORMAT_HPP
+#define FANGPP_BOARD_FORMAT_HPP
+
+#include <cstdint>
+
+// On-disk layout of compiled (binary) board files. A board file consists of
+// a header followed by sections, each starting at an 8-byte aligned offset
+// (relative to the start of the file):
+//  - offsets:  uint32_t[nVertices + 1], CSR offsets into neighbor array
+//  - regularEnds: uint32_t[nVertices], end of regular (non-Boeg) neighbors
+//  - edges:    uint32_t[nEdges], CSR neighbor array (regular neighbors of
+//              each vertex first, followed by Boeg-only ones)
+//  - vertices: BoardFileVertex[nVertices]
+//  - targets:  uint32_t[nTargets], ids of target vertices
+//  - stations: uint32_t[nStations], ids of (non-target) station vertices
+//  - strings:  char[stringTableSize], location names (not null-terminated)
+//  - weights:  uint8_t[nEdges], dice steps of each edge (only present on
+//              weighted boards, i.e., if weightsOffset != 0)
+// Note: All values are stored in native (little-endian) byte order
+
+static constexpr const char boardFileMagic[8] = {'F', 'A', 'N', 'G', 'B', 'R', 'D', '\0'};
+static constexpr const uint32_t boardFileVersion = 3;
+
+struct BoardFileHeader {
+    char magic[8];             // must equal boardFileMagic
+    uint32_t version;          // must equal boardFileVersion
+    uint32_t graphType;        // Graph::GRAPH_TYPE
+    uint32_t nVertices;        // #vertices
+    uint32_t nEdges;           // #entries in CSR edge array
+    uint32_t nTargets;         // #target vertices
+    uint32_t nStations;        // #station vertices
+    uint64_t stringTableSize;  // #bytes of string table
+    uint64_t offsetsOffset;    // file offset of each section
+    uint64_t regularEndsOffset;
+    uint64_t edgesOffset;
+    uint64_t verticesOffset;
+    uint64_t targetsOffset;
+    uint64_t stationsOffset;
+    uint64_t stringsOffset;
+    uint64_t weightsOffset;    // 0 if all edges weigh 1
+};
+
+struct BoardFileVertex {
+    uint32_t nameOffset;  // start of location name in string table
+    uint32_t nameLength;  // length of location name
+    float xpos;
+    float ypos;
+    uint8_t isTarget;
+    uint8_t padding[3];
+};
+
+#endif /* FANGPP_BOARD_FORMAT_HPP */
@@ -0,0 +1,57 @@
+#ifndef FANGPP_BOARD_REGISTRY_HPP
+#define FANGPP_BOARD_REGISTRY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <fangpp/graph.hpp>
+
+// Loaded boards, shared read-only by any number of games. Each board file is
+// loaded (and its distance tables and reachability index, or optionally its
+// distance oracle, precomputed) once.
+// Boards are keyed by path and content hash: a modified file is loaded anew,
+// while games still playing on the old board keep it alive. A board is
+// released as soon as no game references it anymore
+class BoardRegistry {
+public:
+    BoardRegistry() = default;
+    
+    BoardRegistry(const BoardRegistry &) = delete;
+    BoardRegistry &operator=(const BoardRegistry &) = delete;
+    
+    // Shared board of file, loaded on first request
+    // Note: Thread-safe; concurrent requests for one file load it once
+    std::shared_ptr<const Graph> acquire(const char *boardFile);
+    
+    // Precompute distance oracles for boards loaded from now on that are too
+    // large for distance tables
+    // Note: Off by default, as labels of large boards take long to build
+    void setDistanceOracleEnabled(const bool isEnabled)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isDistanceOracleEnabled = isEnabled;
+    }
+    
+    // Registry used by games constructed from a board file name
+    static BoardRegistry &global();
+    
+    // 64-bit FNV-1a hash of the contents of a file
+    static uint64_t hashFile(const char *boardFile);
+    
+    static uint64_t hashFile(const MappedFile &file);
+
+private:
+    struct Entry {
+        uint64_t hash;                      // content hash of loaded file
+        std::weak_ptr<const Graph> board;   // expires with last game using it
+    };
+    
+    std::mutex mutex;                                // guards 'boards'
+    std::unordered_map<std::string, Entry> boards;   // canonical path -> board
+    bool isDistanceOracleEnabled = false;            // see setDistanceOracleEnabled()
+};
+
+#endif /* FANGPP_BOARD_REGISTRY_HPP */
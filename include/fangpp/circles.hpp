@@ -12,6 +12,9 @@ public:
     
     void updateProjection(const GLfloat width, const GLfloat height) const;
     
+    // Replace instance positions and colors, e.g., after the board changed
+    void updateVertices(const std::vector<Vertex> &vertices);
+    
     void draw() const;
     
     void animateColors(const GLfloat currentTime, const std::array<uint32_t, 7> &positions) const;
@@ -22,6 +25,9 @@ public:
     static constexpr const GLuint nTrianglesCircle = 64;
     
 private:
+    // Colors of station and target vertices
+    static std::vector<glm::vec3> computeInstanceColors(const std::vector<Vertex> &vertices);
+    
     GLuint nInstances              = 0;
     GLuint vaoCircles              = 0;
     GLuint vboCirclesVert          = 0;
@@ -0,0 +1,66 @@
+#ifndef FANGPP_FILE_WATCHER_HPP
+#define FANGPP_FILE_WATCHER_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <stdexcept>
+
+#include <sys/inotify.h>  // inotify_init1, inotify_add_watch
+#include <unistd.h>       // read, close
+
+// Notifies of changes to a file through inotify. The directory of the file
+// is watched rather than the file itself, as editors tend to save by
+// replacing the file (which ends a watch on the file)
+class FileWatcher {
+public:
+    explicit FileWatcher(const char *filename) :
+        fileName(std::filesystem::path(filename).filename().string())
+    {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to initialize inotify: " + std::string(std::strerror(errno)));
+        }
+        
+        const std::filesystem::path directory = std::filesystem::absolute(filename).parent_path();
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            const int error = errno;
+            close(fd);
+            throw std::runtime_error("Failed to watch " + directory.string() + ": " + std::strerror(error));
+        }
+    }
+    
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+    
+    ~FileWatcher()
+    {
+        close(fd);
+    }
+    
+    // Whether the file was written or replaced since the last call. Drains
+    // all pending events without blocking
+    bool hasChanged()
+    {
+        alignas(inotify_event) char buffer[4096];
+        bool isChanged = false;
+        
+        ssize_t nRead;
+        while ((nRead = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < nRead; ) {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                if (event->len > 0 && fileName == event->name) isChanged = true;
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+        
+        return isChanged;
+    }
+
+private:
+    std::string fileName;  // name of file within watched directory
+    int fd = -1;           // inotify instance
+};
+
+#endif /* FANGPP_FILE_WATCHER_HPP */
@@ -2,21 +2,45 @@
 #define FANGPP_GAME_STATE_HPP
 
 #include <fangpp/graph.hpp>
+#include <fangpp/board_registry.hpp>
 #include <fangpp/player.hpp>
 #include <fangpp/move_strategy.hpp>
+#include <fangpp/pcg32.hpp>
 
 #include <random>
 #include <array>
 #include <limits>
+#include <memory>
 
 class Player;
+enum StrategyType : uint8_t;
 
 struct Boeg {
     uint32_t position;  // position of Boeg on board
     uint8_t playerId;   // id of player that is currently controlling boeg
 };
 
-class Game : public Graph {
+// Everything about a game that changes while it is played, e.g., to try
+// moves in a search and return to the position. The board, the targets
+// dealt to players and the move order are fixed until the game is
+// initialized again, so a snapshot only fits the game that exported it
+// Note: Trivially copyable, 64 bytes
+struct GameSnapshot {
+    static constexpr uint8_t maxPlayers = 6;
+    static constexpr uint8_t maxTargetsPlayer = 16;
+    
+    Pcg32 prng;
+    std::array<uint32_t, maxPlayers> positions;          // position of each player
+    std::array<uint16_t, maxPlayers> activeTargetMasks;  // see Player::getActiveTargetMask()
+    uint32_t boegPosition;
+    uint32_t diceRoll;                                   // eyes rolled for current player
+    uint8_t boegPlayerId;                                // number of players if nobody's
+    uint8_t moveIndex;                                   // current index into move order
+};
+
+// State of a single game. The board is shared with other games and never
+// modified, so a game only holds the state of its players and the Boeg
+class Game {
 public:
 
     enum Status {
@@ -27,18 +51,49 @@ public:
         GAME_OVER      = (1 << 4)   // all (but one) player have finished the game
     };
     
+    // Play on board of file, shared through BoardRegistry::global().
+    // Each move rolls '_nDice' six-sided dice and takes their sum of eyes
+    // as steps. Player i is controlled by a strategy of type
+    // '_strategyTypes[i]' (default: the user plays the first player
+    // against avoidant ones)
     Game(const char *boardFile, const uint8_t _nPlayers, 
-        const uint8_t _nTargetsPlayer);
+        const uint8_t _nTargetsPlayer, const uint8_t _nDice = 1,
+        std::vector<StrategyType> _strategyTypes = {});
+    
+    // Note: Boards not acquired from a registry miss the precomputed
+    //       tables, unless the caller has built them
+    Game(std::shared_ptr<const Graph> _board, const uint8_t _nPlayers,
+        const uint8_t _nTargetsPlayer, const uint8_t _nDice = 1,
+        std::vector<StrategyType> _strategyTypes = {});
+    
+    const Graph &getBoard() const { return *board; }
+    
+    // Continue on another board (e.g., after its file changed) with a new
+    // game. Throws and keeps the current board if the new one does not
+    // suit the players and targets of this game
+    void setBoard(std::shared_ptr<const Graph> _board);
     
     void initializeState();
-        
+    
+    // Capture the state of the current game, or return to a captured one
+    // (see GameSnapshot)
+    GameSnapshot exportSnapshot() const;
+    void importSnapshot(const GameSnapshot &snapshot);
+    
+    // Reseed pseudo-random number generator (takes effect with the next
+    // call of initializeState())
+    void seed(const uint32_t value) { prng.seed(value); }
+    
+    // Print each move to stdout (on by default)
+    void setMoveLogging(const bool _isMoveLogging) { isMoveLogging = _isMoveLogging; }
+    
     // Run a single player move of game
     Status makeMove();
     
     std::vector<uint32_t> getOpponentPositions(const Player &player) const;
     
     void validateMove(const Player &player, const std::vector<uint32_t> &path, 
-        const uint32_t diceRoll);
+        const uint32_t diceRoll) const;
     
     Status checkPlayerFinished(Player &player, uint32_t endPosition);
     
@@ -60,6 +115,8 @@ public:
     
     uint8_t getNTargetsPlayer() const { return nTargetsPlayer; }
     
+    uint8_t getNDice() const { return nDice; }
+    
     uint32_t getCurrentPlayerNumTargets() const;
     
     void setUserClickedPosition(const uint32_t pos);
@@ -74,18 +131,25 @@ public:
     
     void rollDice();
 private:
+
+    // Throws if board has too few targets or no station
+    void checkBoard(const Graph &candidate) const;
     
     void printMove(const std::vector<uint32_t> &move) const;
     
+    std::shared_ptr<const Graph> board;  // shared, immutable board
     std::vector<Player> players;  // per player data
     std::vector<uint8_t> moveOrder;  // order in which players move
+    std::vector<StrategyType> strategyTypes;  // strategy controlling each player
     Boeg boeg;  // special player character
     uint32_t m_diceRoll;  // currently rolled number of eyes
     uint8_t moveIndex;  // current index in moveOrder array
     uint8_t nTargetsPlayer;  // #targets for each player
     uint8_t nPlayers;  // #players playing the game
     uint8_t nActivePlayers;  // #players actively playing the game
-    std::mt19937 prng;  // pseudo-random number generator
+    uint8_t nDice;  // #dice rolled per move
+    bool isMoveLogging = true;  // print moves (debug)
+    Pcg32 prng;  // pseudo-random number generator
 };
 
 #endif /* FANGPP_GAME_STATE_HPP */
@@ -0,0 +1,119 @@
+#ifndef FANGPP_GENERATOR_HPP
+#define FANGPP_GENERATOR_HPP
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Lazily evaluated sequence produced by a coroutine, i.e., the subset of
+// C++23 std::generator needed here. Values are yielded by reference and stay
+// valid until the generator is resumed (iterator incremented). Leaving the
+// range-for loop early destroys the coroutine and thereby stops its work
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        Generator get_return_object()
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        
+        std::suspend_always yield_value(const T &_value) noexcept
+        {
+            value = std::addressof(_value);
+            return {};
+        }
+        
+        void return_void() noexcept {}
+        
+        void unhandled_exception() { exception = std::current_exception(); }
+        
+        // Note: Generators only yield, they never await
+        template <typename U>
+        std::suspend_never await_transform(U &&) = delete;
+        
+        const T *value = nullptr;      // currently yielded value
+        std::exception_ptr exception;  // exception escaping coroutine body
+    };
+    
+    using Handle = std::coroutine_handle<promise_type>;
+    
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+        
+        iterator() = default;
+        
+        explicit iterator(const Handle _handle) : handle(_handle) {}
+        
+        const T &operator*() const { return *handle.promise().value; }
+        const T *operator->() const { return handle.promise().value; }
+        
+        iterator &operator++()
+        {
+            resume(handle);
+            return *this;
+        }
+        
+        void operator++(int) { ++*this; }
+        
+        bool operator==(std::default_sentinel_t) const { return !handle || handle.done(); }
+    
+    private:
+        Handle handle = nullptr;
+    };
+    
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+    
+    Generator(Generator &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    
+    Generator &operator=(Generator &&other) noexcept
+    {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        
+        return *this;
+    }
+    
+    ~Generator()
+    {
+        if (handle) handle.destroy();
+    }
+    
+    // Runs coroutine up to first yielded value
+    // Note: May only be called once
+    iterator begin()
+    {
+        if (handle) resume(handle);
+        
+        return iterator(handle);
+    }
+    
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    explicit Generator(const Handle _handle) : handle(_handle) {}
+    
+    // Resume coroutine and rethrow exception escaping its body (if any)
+    static void resume(const Handle handle)
+    {
+        handle.resume();
+        if (handle.done() && handle.promise().exception) {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
+    
+    Handle handle = nullptr;
+};
+
+#endif /* FANGPP_GENERATOR_HPP */
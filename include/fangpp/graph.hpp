@@ -4,78 +4,507 @@
 #include <cstdint>
 #include <cassert>
 #include <vector>
-#include <list>
+#include <array>
 #include <tuple>
 #include <set>
 #include <unordered_set>
 #include <unordered_map>
 #include <span>
+#include <memory>
+#include <functional>
 #include <iostream>  // Debug
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <numeric>
 #include <algorithm>
+#include <limits>
 
-#include "pugixml.hpp"  // Parsing .graphml files
-#include "gl_common.hpp"
+#include <fangpp/generator.hpp>
 
+// Precomputed all-pairs shortest path distances and next-hop routing table
+// of a graph. Both are stored as row-major (V x V) matrices, where row i
+// holds the data for source vertex i. Only feasible for small boards
+class DistanceTable {
+public:
+    DistanceTable() = default;
+    
+    DistanceTable(const uint32_t _nVertices) :
+        nVertices(_nVertices),
+        distances(static_cast<std::size_t>(_nVertices) * _nVertices),
+        nextHops(static_cast<std::size_t>(_nVertices) * _nVertices) {}
+    
+    bool isEmpty() const { return nVertices == 0; }
+    
+    uint32_t minDistance(const uint32_t source, const uint32_t target) const
+    {
+        assert(source < nVertices && target < nVertices && "invalid source/target location");
+        
+        return distances[index(source, target)];
+    }
+    
+    // Same semantics as GraphQuery::followMinPath, but walks the path forward
+    // using the next-hop table and stops after at most 'maxPathLength' steps
+    // Note: The weight of each edge on the path is the drop in distance to
+    //       target it yields, so weighted boards need no edge lookups
+    std::vector<uint32_t> followMinPath(const uint32_t source, 
+        const uint32_t target, const uint32_t maxPathLength) const
+    {
+        const uint32_t distance = minDistance(source, target);
+        if (distance == 0) {
+            // Either source == target or target is unreachable
+            return std::vector<uint32_t>(1, target);
+        }
+        
+        std::vector<uint32_t> path;
+        path.reserve(std::min(distance, maxPathLength) + 1);
+        path.push_back(source);
+        for (uint32_t v = source, steps = 0; v != target; ) {
+            const uint32_t n = nextHops[index(v, target)];
+            steps += minDistance(v, target) - minDistance(n, target);
+            if (steps > maxPathLength) break;
+            
+            path.push_back(n);
+            v = n;
+        }
+        
+        return path;
+    }
+    
+    // Largest board for which tables are built (2 x 8 MiB per table)
+    static constexpr const uint32_t maxVertices = 2048;
+
+private:
+    friend class Graph;
+    
+    std::size_t index(const uint32_t source, const uint32_t target) const
+    {
+        return static_cast<std::size_t>(source) * nVertices + target;
+    }
+    
+    uint32_t nVertices = 0;
+    std::vector<uint16_t> distances;  // distance from source to target (0 if unreachable)
+    std::vector<uint16_t> nextHops;   // first vertex after source on a shortest path to target
+};
+
+// Precomputed exact-length simple path reachability. For every source and
+// every path length k = 1, ..., maxPathLength, stores the set of vertices
+// reachable by a simple path of exactly k edges as a bitset, as well as one
+// witness path for each reachable vertex
+class ReachabilityIndex {
+public:
+    ReachabilityIndex() = default;
+    
+    ReachabilityIndex(const uint32_t _nVertices) :
+        nVertices(_nVertices),
+        nWords((_nVertices + 63) / 64),
+        reachable(static_cast<std::size_t>(maxPathLength) * _nVertices * nWords)
+    {
+        std::size_t nWitnessEntries = 0;
+        for (uint32_t k = 1; k <= maxPathLength; ++k) {
+            witnessOffsets[k - 1] = nWitnessEntries;
+            nWitnessEntries += static_cast<std::size_t>(_nVertices) * _nVertices * (k + 1);
+        }
+        witnesses.resize(nWitnessEntries);
+    }
+    
+    bool isEmpty() const { return nVertices == 0; }
+    
+    bool isIndexed(const uint32_t pathLength) const
+    {
+        return !isEmpty() && pathLength >= 1 && pathLength <= maxPathLength;
+    }
+    
+    bool isReachable(const uint32_t source, const uint32_t target,
+        const uint32_t pathLength) const
+    {
+        assert(target < nVertices && "invalid target location");
+        
+        const uint64_t word = getReachableSet(source, pathLength)[target / 64];
+        return (word >> (target % 64)) & 1;
+    }
+    
+    // Bitset (64 vertices per word) of vertices reachable from source
+    std::span<const uint64_t> getReachableSet(const uint32_t source, 
+        const uint32_t pathLength) const
+    {
+        assert(source < nVertices && isIndexed(pathLength) && "invalid query");
+        
+        return {&reachable[setIndex(source, pathLength)], nWords};
+    }
+    
+    // Simple path of exactly 'pathLength' edges from source to target
+    // (empty if there is none)
+    std::vector<uint32_t> getWitnessPath(const uint32_t source, 
+        const uint32_t target, const uint32_t pathLength) const
+    {
+        if (!isReachable(source, target, pathLength)) return {};
+        
+        const uint16_t *witness = &witnesses[witnessIndex(source, target, pathLength)];
+        return std::vector<uint32_t>(witness, witness + pathLength + 1);
+    }
+    
+    // Largest board and dice roll for which the index is built
+    // Note: Witnesses of 133 vertices need ~1 MiB per role
+    static constexpr const uint32_t maxVertices = 256;
+    static constexpr const uint32_t maxPathLength = 6;
+    
+    // Simple paths enumerated per role before the index is given up (the
+    // paths grow as degree^maxPathLength, so dense boards are not indexed)
+    static constexpr const uint64_t maxPathVisits = uint64_t(1) << 24;
+
+private:
+    friend class Graph;
+    
+    std::size_t setIndex(const uint32_t source, const uint32_t pathLength) const
+    {
+        return (static_cast<std::size_t>(pathLength - 1) * nVertices + source) * nWords;
+    }
+    
+    std::size_t witnessIndex(const uint32_t source, const uint32_t target,
+        const uint32_t pathLength) const
+    {
+        return witnessOffsets[pathLength - 1] + 
+            (static_cast<std::size_t>(source) * nVertices + target) * (pathLength + 1);
+    }
+    
+    uint32_t nVertices = 0;
+    uint32_t nWords = 0;                  // #64-bit words per bitset
+    std::vector<uint64_t> reachable;      // bitsets of reachable vertices
+    std::vector<uint16_t> witnesses;      // witness path of each (source, target, length)
+    std::array<std::size_t, maxPathLength> witnessOffsets{};  // start of witnesses per length
+};
+
+// Exact distance oracle for boards too large for a DistanceTable: pruned
+// landmark labeling (Akiba et al., 2013). Every vertex keeps a label of
+// (hub, distance) pairs, such that some hub on a shortest path from u to v
+// appears in the out-label of u and in the in-label of v. A query merges
+// both labels, which are sorted by hub. Undirected boards share one label
+// per vertex. Labels of road-like boards hold few hubs, so memory stays
+// close to linear in the number of vertices
+class DistanceOracle {
+public:
+    DistanceOracle() = default;
+    
+    bool isEmpty() const { return nVertices == 0; }
+    
+    // Distance from source to target (0 if unreachable, as for DistanceTable)
+    uint32_t minDistance(const uint32_t source, const uint32_t target) const
+    {
+        assert(source < nVertices && target < nVertices && "invalid source/target location");
+        
+        const LabelEntry *out = &labels[outOffsets[source]];
+        const LabelEntry *in = &labels[inOffsets[target]];
+        uint32_t distance = std::numeric_limits<uint32_t>::max();
+        // Note: Both labels end in a sentinel hub, which is larger than all
+        //       others
+        while (true) {
+            if (out->hub == in->hub) {
+                if (out->hub == sentinelHub) break;
+                distance = std::min(distance, out->distance + in->distance);
+                ++out;
+                ++in;
+            } else if (out->hub < in->hub) {
+                ++out;
+            } else {
+                ++in;
+            }
+        }
+        
+        return (distance != std::numeric_limits<uint32_t>::max()) ? distance : 0;
+    }
+    
+    // Number of (hub, distance) pairs over all labels
+    std::size_t getNLabelEntries() const { return labels.size() - nLabels; }
+    
+    // Building stops (and nothing is built) once labels hold more than this
+    // many entries per vertex on average
+    static constexpr const uint32_t maxAverageLabelSize = 256;
+
+private:
+    friend class Graph;
+    
+    struct LabelEntry {
+        uint32_t hub;       // rank of hub vertex (order in which hubs were searched)
+        uint32_t distance;  // distance between vertex and hub
+    };
+    
+    static constexpr const uint32_t sentinelHub = std::numeric_limits<uint32_t>::max();
+    
+    uint32_t nVertices = 0;
+    uint32_t nLabels = 0;                  // #labels (each ends in a sentinel)
+    std::vector<std::size_t> outOffsets;   // start of out-label of each vertex in 'labels'
+    std::vector<std::size_t> inOffsets;    // start of in-label (same as out-label if undirected)
+    std::vector<LabelEntry> labels;        // contiguous array of labels
+};
+
+// Per-vertex search state, packed so that a visit touches a single record
+struct QueryRecord {
+    uint32_t distance;  // distance from source to vertex
+    uint32_t child;     // used to reconstruct path from source to target
+    uint32_t stamp;     // generation in which vertex was visited (0 if never)
+};
+
+class Graph;
+
+// Note: Visited marks are generation stamps. Resetting a query merely starts
+//       a new generation, which invalidates all previous marks in O(1).
+//       Records of vertices not visited in the current generation are stale
 struct GraphQuery {
     GraphQuery() = default;
     
     GraphQuery(const uint32_t nVertices) :
-        distances(nVertices),
-        children(nVertices),
-        visited(nVertices) {}
+        records(nVertices),
+        searchList(nVertices) {}
     
     void reset() 
     {
-        for (uint32_t i = 0; i < distances.size(); ++i) {
-            distances[i] = 0;
-            children[i] = 0;
-            visited[i] = 0;
+        table = nullptr;
+        oracle = nullptr;
+        if (++generation == 0) {
+            // Stamps wrapped around: clear them for real (once every 2^32 resets)
+            std::fill(records.begin(), records.end(), QueryRecord{});
+            generation = 1;
+        }
+    }
+    
+    // Make sure buffers can hold the search state of 'nVertices' vertices
+    void reserve(const uint32_t nVertices)
+    {
+        if (records.size() < nVertices) {
+            // Note: New records have stamp 0, i.e., count as not visited
+            records.resize(nVertices);
+            searchList.resize(nVertices);
         }
     }
     
+    bool isVisited(const uint32_t v) const { return records[v].stamp == generation; }
+    
+    void visit(const uint32_t v) { records[v].stamp = generation; }
+    
+    void unvisit(const uint32_t v) { records[v].stamp = 0; }
+    
+    // Answer queries from the row of 'source' in a precomputed distance table
+    // instead of the buffers below
+    void bindTable(const DistanceTable *_table, const uint32_t _source)
+    {
+        table = _table;
+        source = _source;
+    }
+    
+    // Answer queries for 'source' from a distance oracle of graph (paths are
+    // followed along neighbors that the oracle places on a shortest path)
+    void bindOracle(const DistanceOracle *_oracle, const Graph *_graph,
+        const uint32_t _source, const bool _isBoeg)
+    {
+        oracle = _oracle;
+        graph = _graph;
+        source = _source;
+        isBoeg = _isBoeg;
+    }
+    
     uint32_t minDistance(const uint32_t target) const
     { 
-        assert(target < distances.size() && "invalid target location");
+        if (table) return table->minDistance(source, target);
+        if (oracle) return oracle->minDistance(source, target);
         
-        return distances[target];
+        assert(target < records.size() && "invalid target location");
+        
+        return isVisited(target) ? records[target].distance : 0;
     }
     
     std::vector<uint32_t> followMinPath(const uint32_t target, 
         const uint32_t maxPathLength) const
     {
-        assert(target < distances.size() && "invalid target location");
-        
-        const uint32_t distance = distances[target];
-        const uint32_t pathLength = std::min(distance, maxPathLength);
-        // Follow path in reverse order: "children" are actually parents in this case
-        std::vector<uint32_t> path(pathLength + 1);
-        for (uint32_t v = target, i = distance ;; v = children[v], --i) {
-            if (i <= pathLength)
-                path[i] = v;
-            // Last iteration
-            if (i == 0) break;
+        if (table) return table->followMinPath(source, target, maxPathLength);
+        if (oracle) return followOraclePath(target, maxPathLength);
+        
+        assert(target < records.size() && "invalid target location");
+        
+        // Follow path in reverse order: "children" are actually parents in this
+        // case. Keep the vertices within 'maxPathLength' steps of source
+        // Note: On weighted boards, distances count steps, not edges
+        std::vector<uint32_t> path;
+        for (uint32_t v = target ;; v = records[v].child) {
+            const uint32_t distance = minDistance(v);
+            if (distance <= maxPathLength)
+                path.push_back(v);
+            // Last iteration (source or unreachable target)
+            if (distance == 0) break;
         }
+        std::reverse(path.begin(), path.end());
         
         return path;
     }
     
-    std::vector<uint32_t> distances;  // distance from source to each vertex
-    std::vector<uint32_t> children;   // used to reconstruct path from source to target
-    std::vector<uint8_t> visited;     // 1 if vertex has been visited before, 0 otherwise
+    std::vector<QueryRecord> records;      // search state of each vertex
+    std::vector<uint32_t> searchList;      // preallocated BFS frontier (FIFO)
+    std::vector<std::vector<uint32_t>> buckets;  // Dial bucket queue (weighted boards)
+    std::vector<uint32_t> candidates;      // neighbor stack of exact-length path search
+    uint32_t generation = 1;               // stamp of vertices visited since last reset
+    const DistanceTable *table = nullptr;  // precomputed distances (if bound)
+    const DistanceOracle *oracle = nullptr;  // distance oracle (if bound)
+    const Graph *graph = nullptr;          // graph of bound oracle
+    uint32_t source = 0;                   // source vertex of bound table row/oracle
+    bool isBoeg = false;                   // edges of bound oracle
+
+private:
+    std::vector<uint32_t> followOraclePath(const uint32_t target,
+        const uint32_t maxPathLength) const;
 };
 
-struct Edge {
-    Edge() = default;
+// Query buffers borrowed from a thread-local pool for the lifetime of this
+// object. Avoids both per-search allocations and sharing buffers between
+// threads
+class ScopedQuery {
+public:
+    explicit ScopedQuery(const uint32_t nVertices);
+    
+    ScopedQuery(const ScopedQuery &) = delete;
+    ScopedQuery &operator=(const ScopedQuery &) = delete;
+    
+    ScopedQuery(ScopedQuery &&other) noexcept : query(std::move(other.query)) {}
     
-    Edge(uint32_t _nborId, uint8_t _isBoegOnly) :
-        nborId(_nborId), isBoegOnly(_isBoegOnly) {}
+    GraphQuery &operator*() const { return *query; }
+    GraphQuery *operator->() const { return query.get(); }
+    
+    // Returns buffers to the pool of the calling thread
+    ~ScopedQuery();
+
+private:
+    std::unique_ptr<GraphQuery> query;
+};
+
+// Neighbor lists in compressed sparse row form, as stored by Graph
+struct CSRAdjacency {
+    std::vector<uint32_t> offsets;      // start of neighbors of each vertex (and end of last)
+    std::vector<uint32_t> regularEnds;  // end of regular (start of Boeg-only) neighbors
+    std::vector<uint32_t> nbors;        // neighbor ids
+    std::vector<uint8_t> weights;       // edge weights (empty if all edges weigh 1)
+    uint32_t maxWeight = 1;             // largest edge weight
+};
+
+// Builds CSR adjacency from an edge list in two passes: threads count the
+// degrees of their chunk of edges in histograms of their own, a prefix sum
+// over vertices (and threads) yields the offsets, then every thread
+// scatters its chunk into the slots its histogram reserved. Neighbors of
+// each vertex thus end up in input order, whatever the number of threads
+class CSRBuilder {
+public:
+    // Receives the edges of one pass of a streaming build (see below)
+    class EdgeSink {
+    public:
+        // Edge from vertex id 'source' to 'target' (one direction only)
+        void add(const uint32_t source, const uint32_t target, const bool isBoegOnly,
+            const uint8_t weight)
+        {
+            if (isFillPass) {
+                const uint32_t v = vertexIndexes[source];
+                const uint32_t slot = (isBoegOnly) ? adjacency->regularEnds[v] + boegOnlyCounts[v]++
+                                                   : adjacency->offsets[v] + regularCounts[v]++;
+                adjacency->nbors[slot] = vertexIndexes[target];
+                if (!adjacency->weights.empty()) adjacency->weights[slot] = weight;
+            } else {
+                std::vector<uint32_t> &counts = (isBoegOnly) ? boegOnlyCounts : regularCounts;
+                if (source >= counts.size()) counts.resize(source + 1, 0);
+                ++counts[source];
+                maxWeight = std::max(maxWeight, weight);
+            }
+        }
         
-    uint32_t nborId;     // vertex id of neighboring "target"-vertex
-    uint8_t isBoegOnly;  // this edge is accessible only to the Boeg
+        // Whether this is the second pass
+        bool isFilling() const { return isFillPass; }
+    
+    private:
+        friend class CSRBuilder;
+        
+        bool isFillPass = false;
+        uint8_t maxWeight = 1;
+        // Degrees of ids while counting, slots taken of vertices while filling
+        std::vector<uint32_t> regularCounts;
+        std::vector<uint32_t> boegOnlyCounts;
+        std::vector<uint32_t> vertexIndexes;  // vertex index of each id
+        CSRAdjacency *adjacency = nullptr;
+    };
+    
+    // 'nThreads' 0: one per hardware thread
+    explicit CSRBuilder(const uint32_t _nThreads = 0);
+    
+    // For undirected boards every input edge is stored in both directions.
+    // Within the neighbors of each vertex, regular edges precede Boeg-only
+    // ones. Weights are only stored if some edge weighs more than 1 (empty
+    // 'edgeWeights': none does)
+    CSRAdjacency build(const uint32_t nVertices, const bool isUndirected,
+        const std::vector<uint32_t> &edgeSources,
+        const std::vector<uint32_t> &edgeTargets,
+        const std::vector<uint8_t> &edgeBoegFlags,
+        const std::vector<uint8_t> &edgeWeights) const;
+    
+    // Same, for loaders that parse edges instead of holding an edge list.
+    // Edges name their ends by small ids of the loader's choosing, as they
+    // may precede the vertices they refer to, and are directed (undirected
+    // boards add both directions). 'forEachEdge' passes all edges to the
+    // sink twice, to count degrees and then to fill neighbors, in the same
+    // order both times. In between, 'resolveIds' stores the vertex index of
+    // every id and returns the number of vertices. Runs on the calling
+    // thread only
+    CSRAdjacency build(const std::function<void(EdgeSink &)> &forEachEdge,
+        const std::function<uint32_t(std::vector<uint32_t> &)> &resolveIds) const;
+    
+    // Fewer edges per thread do not pay for starting it
+    static constexpr const std::size_t minEdgesPerThread = 1 << 18;
+
+private:
+    // Offsets and regular ends of 'adjacency' from the degree histograms of
+    // all chunks, which turn into the slots earlier chunks take
+    static void computeOffsets(const uint32_t nVertices,
+        std::vector<std::vector<uint32_t>> &histograms, CSRAdjacency &adjacency);
+    
+    uint32_t nThreads;
+};
+
+// Adjacency matrix of a small unweighted board with one row of bits per
+// vertex (outgoing and incoming edges, regular and Boeg). Searches expand
+// whole frontiers and neighbor sets by a few word operations instead of
+// walking neighbor lists. Engines are compiled for a few vertex bounds, of
+// which the smallest that fits the board is picked (see create())
+class BitMatrixEngine {
+public:
+    virtual ~BitMatrixEngine() = default;
+    
+    // Engine for boards of up to 'nVertices' vertices (null if too large)
+    static std::unique_ptr<BitMatrixEngine> create(const uint32_t nVertices);
+    
+    // Add edge u -> v (for the Boeg only if 'isBoegOnly' is set)
+    virtual void setEdge(const uint32_t u, const uint32_t v, const bool isBoegOnly) = 0;
+    
+    // Remove edge u -> v (for all players)
+    virtual void clearEdge(const uint32_t u, const uint32_t v) = 0;
+    
+    virtual bool hasEdge(const uint32_t u, const uint32_t v, const bool isBoeg) const = 0;
+    
+    // Same semantics as the Graph members of the same name
+    // Note: BFS parents are the frontier vertex of smallest id, which may
+    //       differ from the parents a search along neighbor lists finds
+    virtual uint32_t breadthFirstSearch(const uint32_t source, GraphQuery &spQuery,
+        const bool isBoeg) const = 0;
+    
+    // Note: An empty path with an exhausted 'visitBudget' means that the
+    //       search gave up, not that there is no such path
+    virtual std::vector<uint32_t> findPathOfLength(const uint32_t source,
+        const uint32_t target, const uint32_t pathLength, const bool isBoeg,
+        uint32_t &visitBudget) const = 0;
+    
+    virtual bool isValidPath(const std::vector<uint32_t> &path, const uint32_t source,
+        const bool isBoeg) const = 0;
+    
+    // Vertices reachable by a simple path of exactly 'pathLength' edges from
+    // source, by increasing id
+    virtual std::vector<uint32_t> findReachableEndpoints(const uint32_t source,
+        const uint32_t pathLength, const bool isBoeg) const = 0;
+    
+    // Largest vertex bound engines are compiled for
+    static constexpr const uint32_t maxVertices = 512;
 };
 
 struct Vertex {
@@ -83,27 +512,159 @@ struct Vertex {
     
     Vertex(const std::string &_location, float _xpos, float _ypos) :
         location(_location), xpos(_xpos), ypos(_ypos) {}
-        
+    
     std::string location;  // name of location represented by vertex
     float xpos;            // screen x-position of vertex
     float ypos;            // screen y-position of vertex
     uint8_t isTarget;
 };
 
-struct LineVertex
-{
-    glm::vec2 pos;
-    glm::vec3 col;
+// Edge between two vertices (see Graph::getEdges())
+struct Edge {
+    uint32_t source;
+    uint32_t target;
+    bool isBoegOnly;  // only usable by a player who rolled "boeg"
 };
 
+// Parameters of the force-directed board layout (see Graph::computeLayout())
+struct LayoutOptions {
+    uint32_t nIterations = 100;  // simulation steps
+    uint32_t nThreads = 0;       // worker threads (0: one per hardware thread)
+    float theta = 1.0f;          // Barnes-Hut opening criterion (0: exact repulsion)
+    bool isRandomStart = false;  // ignore current positions
+    uint32_t seed = 1;           // seed of random start positions
+};
+
+// Parameters of board analytics (see Graph::computeAnalytics())
+struct AnalyticsOptions {
+    uint32_t nThreads = 0;  // worker threads (0: one per hardware thread)
+    uint32_t nSamples = 0;  // sources of estimated betweenness (0: all, i.e., exact)
+    uint32_t seed = 1;      // seed of sampled sources
+};
+
+// Statistics of the player or Boeg subgraph of a board. Distances count
+// dice steps
+struct BoardAnalytics {
+    std::vector<double> betweenness;       // betweenness centrality of each vertex
+    std::vector<uint32_t> eccentricities;  // largest distance to a reachable vertex
+    uint32_t diameter = 0;                 // largest eccentricity
+    uint32_t radius = 0;                   // smallest eccentricity of a non-isolated vertex
+    // Distances from stations to each target (in order of getTargetVertices()):
+    // entry d counts the stations d steps away, unreachable ones are
+    // counted separately
+    std::vector<std::vector<uint32_t>> targetDistanceCounts;
+    std::vector<uint32_t> unreachableStations;
+};
+
+class MappedFile;
+
 class Graph {
+    friend struct GraphQuery;  // follows paths of bound oracles
+
 public:    
     enum GRAPH_TYPE {
         GRAPH_DIRECTED = 0,
         GRAPH_UNDIRECTED
     };
     
-    Graph(const char *graphFile);
+    // Internal numbering of vertices (see reorderVertices())
+    enum VERTEX_ORDER {
+        ORDER_FILE = 0,  // as given by the board file
+        ORDER_BFS,       // breadth-first order
+        ORDER_RCM        // reverse Cuthill-McKee order
+    };
+    
+    // Load board from a GraphML file or, depending on its extension, from a
+    // compiled binary board file (.fbrd, see board_format.hpp) or a plain-text
+    // edge list (.txt, see loadText()). Vertices are optionally relabeled
+    Graph(const char *graphFile, const VERTEX_ORDER order = ORDER_FILE);
+    
+    // Load board from the mapped contents 'file' of 'graphFile' (whose
+    // extension selects the format as above)
+    Graph(const MappedFile &file, const char *graphFile, const VERTEX_ORDER order = ORDER_FILE);
+    
+    // Relabel vertices such that neighbors have close ids, which keeps BFS
+    // frontiers (and query buffers) of large boards in fewer cache lines.
+    // All ids taken or returned by Graph are internal ids: vertices, targets
+    // and stations are permuted along, so locations and screen positions
+    // stay attached to the same vertex. Use getOriginalId()/getInternalId()
+    // to translate ids exchanged with the outside world
+    // Note: Precomputed tables are rebuilt for the new numbering
+    void reorderVertices(const VERTEX_ORDER order);
+    
+    // Id of vertex in the board file
+    uint32_t getOriginalId(const uint32_t v) const
+    {
+        return (originalIds.empty()) ? v : originalIds[v];
+    }
+    
+    uint32_t getInternalId(const uint32_t originalId) const
+    {
+        return (internalIds.empty()) ? originalId : internalIds[originalId];
+    }
+    
+    // Build board from vertices (including positions and target flags) and
+    // a list of edges, e.g., of a generated board. Edges weigh 1 step unless
+    // weights are given
+    Graph(const GRAPH_TYPE type, std::vector<Vertex> _vertices,
+        const std::vector<uint32_t> &edgeSources,
+        const std::vector<uint32_t> &edgeTargets,
+        const std::vector<uint8_t> &edgeBoegFlags,
+        const std::vector<uint8_t> &edgeWeights = {});
+    
+    // Write board as compiled binary board file
+    void writeBinary(const char *boardFile) const;
+    
+    // Write board as GraphML file (vertex ids become 'n<id>')
+    void writeGraphML(const char *graphFile) const;
+    
+    // Write board as plain-text edge list (see loadText())
+    void writeText(const char *boardFile) const;
+    
+    // Write board in the format given by the file extension (as Graph())
+    void writeBoard(const char *boardFile) const;
+    
+    // Compute screen positions with a force-directed layout (Fruchterman &
+    // Reingold, 1991): edges pull their ends together, all vertices repel
+    // each other. Repulsion is approximated by a Barnes-Hut quadtree and
+    // forces are computed in parallel. Positions end up in [-0.95, 0.95]
+    // Note: Starts from the current positions unless these are degenerate.
+    //       Random starts of large boards tend to end up folded
+    void computeLayout(const LayoutOptions &options = LayoutOptions());
+    
+    // Betweenness centrality (Brandes, 2001), eccentricities and distances
+    // from stations to targets of the player (or Boeg) subgraph. Searches
+    // from different sources run in parallel. Sampling sources estimates
+    // betweenness on large boards (Brandes & Pich, 2007); eccentricities
+    // stay exact, on undirected boards by bounding them from a few searches
+    // (Takes & Kosters, 2011)
+    // Note: Betweenness counts ordered pairs of vertices on directed boards
+    //       and unordered pairs on undirected ones. Exact eccentricities
+    //       still take a search per vertex on directed boards, and bounds
+    //       converge slowly on boards without geometry (e.g., random graphs)
+    BoardAnalytics computeAnalytics(const bool isBoeg = false,
+        const AnalyticsOptions &options = AnalyticsOptions()) const;
+    
+    // Add edge u -> v (and v -> u on undirected boards) of 'weight' steps,
+    // usable only by the Boeg if 'isBoegOnly' is set. Returns false if the
+    // edge exists already.
+    // Neighbor lists keep free slots, so an edit moves few entries only.
+    // Precomputed distance tables are updated by dynamic BFS: only sources
+    // whose distances change are touched. The reachability index is rebuilt
+    // for sources within ReachabilityIndex::maxPathLength of the edge.
+    // Distance oracles are dropped (call precomputeDistanceOracle() again)
+    // Note: Invalidates paths and query results obtained before the edit
+    bool insertEdge(const uint32_t u, const uint32_t v, const bool isBoegOnly = false,
+        const uint32_t weight = 1);
+    
+    // Remove edge u -> v (and v -> u on undirected boards). Returns false if
+    // there is no such edge. Precomputed structures are kept up to date as
+    // by insertEdge(). Removing the last edge of weight other than 1 makes
+    // the board unweighted again, as if loaded without that edge (the
+    // reachability index may then be precomputed again)
+    bool removeEdge(const uint32_t u, const uint32_t v);
+    
+    bool hasEdge(const uint32_t u, const uint32_t v) const;
     
     uint32_t getNVertices() const noexcept { return nVertices; }
     uint32_t getNEdges() const noexcept { 
@@ -112,48 +673,385 @@ public:
     
     GRAPH_TYPE getGraphType() const noexcept { return graphType; }
     
-    GraphQuery initializeQuery() const;
+    // Whether any edge takes more than one dice step (e.g., a ferry)
+    bool isWeighted() const noexcept { return !weights.empty(); }
+    
+    // Upper bound of edge weights (1 on unweighted boards)
+    // Note: Not lowered when the heaviest edge is removed, unless the board
+    //       becomes unweighted
+    uint32_t getMaxWeight() const noexcept { return maxWeight; }
+    
+    // Number of dice steps a valid path takes (its number of edges on
+    // unweighted boards)
+    uint32_t getPathWeight(const std::vector<uint32_t> &path) const;
+    
+    // Largest weight of an edge in board files
+    static constexpr const uint32_t maxEdgeWeight = 16;
+    
+    // Borrow query buffers for this graph from the pool of the calling thread
+    ScopedQuery acquireQuery() const { return ScopedQuery(nVertices); }
     
+    // Precompute all-pairs distance and next-hop tables for regular and Boeg
+    // edges. Subsequent shortestPaths() calls become table lookups. Returns
+    // false (and builds nothing) if the board is too large
+    bool precomputeDistanceTables();
+    
+    bool hasDistanceTables() const { return !distanceTables[0].isEmpty(); }
+    
+    const DistanceTable &getDistanceTable(const bool isBoeg = false) const
+    {
+        assert(hasDistanceTables() && "distance tables have not been precomputed");
+        
+        return distanceTables[isBoeg];
+    }
+    
+    // Precompute distance oracles (hub labels) for regular and Boeg edges,
+    // meant for boards too large for distance tables. Subsequent
+    // shortestPaths() calls bind the oracle instead of searching, and
+    // multiSourceDistances() queries it pairwise. Returns false (and builds
+    // nothing) if labels exceed DistanceOracle::maxAverageLabelSize
+    // Note: Labels are built one hub after another, which takes long on
+    //       boards with many hubs on shortest paths (e.g., random graphs)
+    bool precomputeDistanceOracle();
+    
+    bool hasDistanceOracle() const { return !distanceOracles[0].isEmpty(); }
+    
+    const DistanceOracle &getDistanceOracle(const bool isBoeg = false) const
+    {
+        assert(hasDistanceOracle() && "distance oracle has not been precomputed");
+        
+        return distanceOracles[isBoeg];
+    }
+    
+    // Whether searches run on adjacency bit matrices, which happens for
+    // unweighted boards of at most BitMatrixEngine::maxVertices vertices
+    bool hasBitMatrix() const { return bitMatrix != nullptr; }
+    
+    // Precompute exact-length reachability (and witness paths) for all
+    // sources and dice rolls up to ReachabilityIndex::maxPathLength.
+    // findPathOfLength() and findAllReachableVertices() then become lookups.
+    // Returns false (and builds nothing) if the board is too large, too
+    // dense (see ReachabilityIndex::maxPathVisits) or weighted
+    bool precomputeReachabilityIndex();
+    
+    bool hasReachabilityIndex() const { return !reachabilityIndexes[0].isEmpty(); }
+    
+    const ReachabilityIndex &getReachabilityIndex(const bool isBoeg = false) const
+    {
+        assert(hasReachabilityIndex() && "reachability index has not been precomputed");
+        
+        return reachabilityIndexes[isBoeg];
+    }
+    
+    // Distances (in dice steps) and shortest paths from source: BFS on
+    // unweighted boards, Dial's bucket queue on weighted ones
     void shortestPaths(const uint32_t source, GraphQuery &spQuery,
         const bool isBoeg = false) const;
     
+    // Shortest path distances from every source to every destination as a
+    // dense row-major (sources x destinations) block, where 0 marks an
+    // unreachable destination (as for shortestPaths()). Answered from the
+    // distance tables if present, otherwise by a bit-parallel BFS from
+    // multiSourceBatchSize sources at a time (one search per source on
+    // weighted boards)
+    std::vector<uint32_t> multiSourceDistances(std::span<const uint32_t> sources,
+        std::span<const uint32_t> destinations, const bool isBoeg = false) const;
+    
+    // Number of sources searched simultaneously (bits per frontier word)
+    static constexpr const uint32_t multiSourceBatchSize = 64;
+    
+    // Color coding parameters: searches for paths of at least
+    // 'colorCodingMinLength' steps switch to color coding after
+    // 'colorCodingSwitchVisits' depth-first visits, with up to
+    // 'colorCodingTrials' colorings. A trial gives up after
+    // 'maxColorCodingStates' states
+    static constexpr const uint32_t colorCodingMinLength = 12;
+    static constexpr const uint32_t colorCodingSwitchVisits = 1 << 20;
+    static constexpr const uint32_t colorCodingTrials = 16;
+    static constexpr const uint32_t maxColorCodingStates = 1 << 16;
+    // Colors per path vertex (more colors make colorful paths likelier, see
+    // Hüffner et al., 2008). Color sets are 64-bit masks, which bounds the
+    // colors and thereby path lengths
+    static constexpr const uint32_t colorCodingColorFactor = 2;
+    static constexpr const uint32_t maxColors = 64;
+    static constexpr const uint32_t maxColorfulPathLength = maxColors - 1;
+    
+    // Note: The following queries are reentrant and may run concurrently on
+    //       the same graph once all precomputations have finished. Path
+    //       lengths count dice steps: on weighted boards, a path of length k
+    //       may have fewer than k edges
+    
+    // Simple path of exactly 'pathLength' steps from source to target (empty
+    // if there is none). Without a reachability index, a depth-first search
+    // runs that skips vertices too far from target for the remaining steps
+    // and tries neighbors whose shortest path to target fits the remaining
+    // steps most closely first. Targets of the wrong parity are rejected
+    // without searching. Long paths fall back to color coding if the search
+    // stalls (see findColorfulPath()), also on bit matrices
     std::vector<uint32_t> findPathOfLength(const uint32_t source, 
         const uint32_t target, const uint32_t pathLength, 
-        const bool isBoeg = false);
+        const bool isBoeg = false) const;
+    
+    // Simple path of exactly 'pathLength' steps from source to target found
+    // by color coding: each of 'nTrials' random colorings of the board is
+    // searched for a path of distinct colors, in time exponential in
+    // 'pathLength' but linear in the size of the board. An empty path means
+    // that no trial succeeded, i.e., there is most likely no such path.
+    // findPathOfLength() switches to it when searches for paths of at least
+    // 'colorCodingMinLength' steps stall
+    std::vector<uint32_t> findColorfulPath(const uint32_t source,
+        const uint32_t target, const uint32_t pathLength, const bool isBoeg = false,
+        const uint32_t nTrials = colorCodingTrials) const;
     
     std::unordered_set<uint32_t> findAllReachableVertices(
         const uint32_t source, const uint32_t pathLength, 
-        const bool isBoeg = false);
+        const bool isBoeg = false) const;
+    
+    // Lazily enumerate all simple paths of exactly 'pathLength' edges from
+    // source, in neighbor order. Each path is a
+    // view that stays valid until the generator is advanced. The search runs
+    // on an explicit stack and stops when the caller stops iterating
+    // Note: The graph must outlive the generator
+    Generator<std::span<const uint32_t>> simplePaths(const uint32_t source,
+        const uint32_t pathLength, const bool isBoeg = false) const;
+    
+    // Lazily enumerate all vertices reachable by a simple path of exactly
+    // 'pathLength' edges from source, each vertex once
+    Generator<uint32_t> reachableEndpoints(const uint32_t source,
+        const uint32_t pathLength, const bool isBoeg = false) const;
+    
+    // Note: A move of 'diceRoll' steps is a simple path that uses up the
+    //       roll or, on weighted boards, ends short where no unvisited
+    //       neighbor fits the remaining steps. Hence on weighted boards, the
+    //       only move stays put if no edge from source fits the roll. On
+    //       unweighted boards, a source without a path of 'diceRoll' steps
+    //       has no move at all (players then stay put, see Game::validateMove())
+    
+    // Whether valid simple path 'path' is a move of 'diceRoll' steps
+    bool isCompleteMove(const std::vector<uint32_t> &path, const uint32_t diceRoll,
+        const bool isBoeg = false) const;
+    
+    // Lazily enumerate the ends of all moves of 'diceRoll' steps from
+    // source, each vertex once (same as reachableEndpoints() on unweighted
+    // boards)
+    Generator<uint32_t> moveEndpoints(const uint32_t source, const uint32_t diceRoll,
+        const bool isBoeg = false) const;
+    
+    // Move of 'diceRoll' steps from source to target (empty if there is
+    // none). Tries a path of exactly 'diceRoll' steps first
+    std::vector<uint32_t> findMovePath(const uint32_t source, const uint32_t target,
+        const uint32_t diceRoll, const bool isBoeg = false) const;
     
     bool isValidPath(const std::vector<uint32_t> &path, const uint32_t source,
-        const bool isBoeg);
-        
+        const bool isBoeg) const;
+    
     const std::vector<Vertex> &getVertices() const { return vertices; };
     
-    std::vector<LineVertex> getLinesFromEdges() const;
+    // Target vertices in board file order
+    const std::vector<uint32_t> &getTargetVertices() const { return targetVertices; }
+    
+    // Non-target vertices (possible start positions of players)
+    const std::vector<uint32_t> &getStationVertices() const { return stationVertices; }
     
+    // Edges by source vertex, regular ones first. Undirected edges are
+    // listed once, from their smaller end
+    std::vector<Edge> getEdges() const;
+
 private:
-    void setVertexFromEntry(Vertex &vert, const std::string &name, 
-        const std::string &value);
-        
+    // Set up the bit matrix engine if the board fits (drop it otherwise)
+    void buildBitMatrix();
+    
+    // Bring row bits of edge u -> v in line with the neighbor lists
+    void updateBitMatrix(const uint32_t u, const uint32_t v);
+    
+    void loadGraphML(const MappedFile &file);
+    
+    void loadBinary(const MappedFile &file);
+    
+    void loadText(const MappedFile &file);
+    
+    void buildAdjacency(const std::vector<uint32_t> &edgeSources,
+        const std::vector<uint32_t> &edgeTargets, 
+        const std::vector<uint8_t> &edgeBoegFlags,
+        const std::vector<uint8_t> &edgeWeights);
+    
+    // Take over CSR arrays built by CSRBuilder
+    void setAdjacency(CSRAdjacency &&adjacency);
+    
     bool findPathOfLengthRecursive(const uint32_t v, const uint32_t target,
-        const uint32_t pathLength, const bool isBoeg);
+        const uint32_t pathLength, const bool isBoeg, GraphQuery &query,
+        const GraphQuery &bounds, const uint32_t outerBound, uint32_t &visitBudget) const;
+    
+    uint32_t computeTargetBounds(const uint32_t source, const uint32_t target,
+        const uint32_t pathLength, const bool isBoeg, GraphQuery &bounds) const;
     
-    void findAllReachableVerticesRecursive(const uint32_t v, 
-        const uint32_t pathLength, const bool isBoeg, 
-        std::unordered_set<uint32_t> &reachable);
+    std::vector<uint32_t> searchColorfulPath(const uint32_t source,
+        const uint32_t target, const uint32_t pathLength, const bool isBoeg,
+        const uint32_t nTrials, const GraphQuery &bounds, const uint32_t outerBound) const;
+    
+    // Lower bound of the steps from v to target (see computeTargetBounds())
+    static uint32_t targetBound(const GraphQuery &bounds, const uint32_t v,
+        const uint32_t outerBound)
+    {
+        const QueryRecord &record = bounds.records[v];
+        
+        return (record.stamp == bounds.generation) ? record.distance : outerBound;
+    }
+    
+    // Parity class of each vertex (see stepParities)
+    std::vector<uint8_t> computeStepParities(const bool isBoeg) const;
+    
+    Generator<std::span<const uint32_t>> enumerateSimplePaths(const uint32_t source,
+        const uint32_t pathLength, const bool isBoeg) const;
+    
+    Generator<uint32_t> enumerateReachableEndpoints(const uint32_t source,
+        const uint32_t pathLength, const bool isBoeg) const;
+    
+    // Whether an edge from v to an unvisited vertex fits 'remaining' steps
+    bool hasFittingEdge(const uint32_t v, const uint32_t remaining, const bool isBoeg,
+        const GraphQuery &query) const;
+    
+    Generator<std::span<const uint32_t>> enumerateMovePaths(const uint32_t source,
+        const uint32_t diceRoll, const bool isBoeg) const;
+    
+    Generator<uint32_t> enumerateMoveEndpoints(const uint32_t source,
+        const uint32_t diceRoll, const bool isBoeg) const;
+    
+    // Range of neighbors of v in 'nbors' accessible to a player or the Boeg
+    // Note: Regular neighbors precede Boeg-only ones, so both views share
+    //       one array and traversals need not check edges individually
+    std::pair<uint32_t,uint32_t> vertexBounds(const uint32_t v, const bool isBoeg) const
+    {
+        assert(v < nVertices && "Invalid vertex index");
         
-    std::pair<uint32_t,uint32_t> vertexBounds(const uint32_t v) const;
+        return std::pair(offsets[v], (isBoeg) ? nborEnds[v] : regularEnds[v]);
+    }
+    
+    // Weight of edge i in 'nbors'
+    uint32_t edgeWeight(const std::size_t i) const
+    {
+        return (weights.empty()) ? 1 : weights[i];
+    }
+    
+    DistanceTable computeDistanceTable(const bool isBoeg) const;
+    
+    // Empty if the paths exceed ReachabilityIndex::maxPathVisits
+    ReachabilityIndex computeReachabilityIndex(const bool isBoeg) const;
+    
+    // Returns false once 'nVisitsLeft' runs out (leaving the index partial)
+    bool indexSimplePathsRecursive(const uint32_t v, const uint32_t depth,
+        std::array<uint32_t, ReachabilityIndex::maxPathLength + 1> &path,
+        std::vector<uint8_t> &visited, ReachabilityIndex &index, 
+        uint64_t &nVisitsLeft, const bool isBoeg) const;
+    
+    uint32_t breadthFirstSearch(const uint32_t source, GraphQuery &spQuery,
+        const bool isBoeg) const;
+    
+    uint32_t dialSearch(const uint32_t source, GraphQuery &spQuery,
+        const bool isBoeg) const;
+    
+    // Dial search that stops at 'maxDistance' steps from source (or earlier
+    // after visiting 'maxVisited' vertices)
+    uint32_t boundedSearch(const uint32_t source, uint32_t &maxDistance,
+        const uint32_t maxVisited, GraphQuery &spQuery, const bool isBoeg) const;
+    
+    uint32_t topDownStep(const uint32_t head, const uint32_t levelEnd,
+        uint32_t tail, GraphQuery &spQuery, const bool isBoeg) const;
+    
+    uint32_t bottomUpStep(const uint32_t level, uint32_t tail, 
+        GraphQuery &spQuery, const bool isBoeg) const;
+    
+    void multiSourceBatch(std::span<const uint32_t> sources,
+        const uint32_t nDestinations, uint32_t *distances, const bool isBoeg) const;
+    
+    std::vector<uint32_t> computeBfsOrder(const bool isReversed) const;
+    
+    DistanceOracle computeDistanceOracle(const bool isBoeg) const;
+    
+    // Exact eccentricities of an undirected board from bounds
+    std::vector<uint32_t> boundEccentricities(const bool isBoeg,
+        const uint32_t nThreads) const;
+    
+    void computeTargetDistances(BoardAnalytics &analytics, const bool isBoeg,
+        const uint32_t nThreads) const;
+    
+    // Shortest path from source to target (truncated after 'maxPathLength'
+    // steps) along neighbors the oracle places on a shortest path
+    std::vector<uint32_t> followOraclePath(const DistanceOracle &oracle, const uint32_t source,
+        const uint32_t target, const uint32_t maxPathLength, const bool isBoeg) const;
+    
+    // Index of v in neighbor list of u (nbors.size() if not adjacent)
+    std::size_t findNbor(const uint32_t u, const uint32_t v) const;
+    
+    void insertNbor(const uint32_t u, const uint32_t v, const bool isBoegOnly,
+        const uint32_t weight);
+    
+    void removeNbor(const uint32_t u, const std::size_t i);
+    
+    void makeRoom(const uint32_t u);
+    
+    // Copy of CSR arrays with 'slack' free slots after each neighbor list
+    void spaceAdjacency(const uint32_t slack, std::vector<uint32_t> &newOffsets,
+        std::vector<uint32_t> &newRegularEnds, std::vector<uint32_t> &newNborEnds,
+        std::vector<uint32_t> &newNbors, std::vector<uint8_t> &newWeights) const;
+    
+    void insertIntoDistanceTable(const uint32_t u, const uint32_t v, const uint32_t weight,
+        const bool isBoeg);
+    
+    void removeFromDistanceTable(const uint32_t u, const uint32_t v, const uint32_t weight,
+        const bool isBoeg);
+    
+    std::vector<uint32_t> findSourcesNear(const uint32_t u, const uint32_t v,
+        const bool isBoeg) const;
+    
+    // Returns false if the paths of sources exceed
+    // ReachabilityIndex::maxPathVisits (leaving the index partial)
+    bool reindexSources(const std::vector<uint32_t> &sources, const bool isBoeg);
     
     uint32_t nVertices;                     // #vertices of graph
     uint32_t nEdges;                        // #edges of graph
-    std::vector<Edge> edges;                // contiguous array of edges
+    std::vector<uint32_t> nbors;            // contiguous array of neighbor ids (edges)
     std::vector<Vertex> vertices;           // contiguous array of vertices
-    std::vector<uint32_t> offsets;          // offsets to start of edge list for each vertex
+    std::vector<uint32_t> offsets;          // offsets to start of neighbor list for each vertex
+    std::vector<uint32_t> regularEnds;      // end of regular (non-Boeg) neighbors for each vertex
+    std::vector<uint32_t> nborEnds;         // end of all neighbors (free slots up to next offset)
+    std::vector<uint8_t> weights;           // dice steps of each edge in 'nbors' (empty if all are 1)
+    uint32_t maxWeight = 1;                 // upper bound of edge weights
+    std::vector<uint32_t> originalIds;      // internal id -> board file id (empty if not reordered)
+    std::vector<uint32_t> internalIds;      // board file id -> internal id (empty if not reordered)
     GRAPH_TYPE graphType;                   // type of graph (dir./undir.)
-
-protected:
-    GraphQuery query;                       // used to query graph (finding paths)
+    std::array<DistanceTable, 2> distanceTables;  // precomputed tables (regular, Boeg)
+    std::array<ReachabilityIndex, 2> reachabilityIndexes;  // precomputed index (regular, Boeg)
+    std::array<DistanceOracle, 2> distanceOracles;  // precomputed oracles (regular, Boeg)
+    std::unique_ptr<BitMatrixEngine> bitMatrix;  // row bits of small boards (null otherwise)
+    // Path lengths between two vertices of a component without cycles of
+    // odd length all have the same parity: the parity classes of both
+    // vertices differ iff it is odd (noParity if the component has such a
+    // cycle). Computed for regular and Boeg edges
+    std::array<std::vector<uint8_t>, 2> stepParities;
+    static constexpr const uint8_t noParity = 2;
+    
+    // Direction-optimizing BFS parameters (see Beamer et al., 2012)
+    static constexpr const uint32_t bottomUpMinVertices = 4096;  // smaller boards stay top-down
+    static constexpr const uint32_t bottomUpAlpha = 14;  // switch to bottom-up
+    static constexpr const uint32_t bottomUpBeta  = 24;  // switch back to top-down
+    
+    // Search for pseudo-peripheral start vertex of reverse Cuthill-McKee order
+    static constexpr const uint32_t maxPeripheralIterations = 8;
+    
+    // Vertices a single exact-length path search may visit to bound the
+    // remaining steps to its target
+    static constexpr const uint32_t maxTargetBoundVertices = 256;
+    
+    // Shortest path trees sampled to order hubs of distance oracles
+    static constexpr const uint32_t oracleSampleRoots = 64;
+    
+    // Free slots per neighbor list when making room for inserted edges, and
+    // how many following lists an insertion may shift before all lists are
+    // spaced out anew
+    static constexpr const uint32_t edgeSlack = 2;
+    static constexpr const uint32_t maxShiftedLists = 64;
+    
     std::vector<uint32_t> targetVertices;   // special vertices marking target locations
     std::vector<uint32_t> stationVertices;  // regular vertices marking (non-target) stations
 };
@@ -7,6 +7,7 @@
 #include "lines.hpp"
 #include "text.hpp"
 #include "game_state.hpp"
+#include "file_watcher.hpp"
 
 #include <iostream>
 #include <string>
@@ -33,6 +34,11 @@ private:
     // Return index of vertex that was clicked by the user if any
     uint32_t getClickedVertexByIndex() const;
     
+    // Load the board file anew after it changed and start a new game on it.
+    // Only the vertex and edge buffers are updated; if loading fails, the
+    // current game continues
+    void reloadBoard();
+    
     // Callbacks
     static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
     static void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
@@ -47,11 +53,14 @@ private:
     Circles circles;
     Lines lines;
     Text text;
+    FileWatcher boardWatcher;  // changes of board file
     
     bool framebufferResized = false;
     // The vertex index that corresponds to the last location that was (mouse-)hovered over
     std::optional<uint32_t> hoverLocationIndex;
     
+    static constexpr const char *boardFile = "graphs/graph_fang.graphml";
+    
     // Default (initial) resolution of window
     static constexpr const GLint defaultWidth  = 1200;
     static constexpr const GLint defaultHeight = 1000;
@@ -4,6 +4,12 @@
 #include "gl_common.hpp"
 #include "graph.hpp"
 
+struct LineVertex
+{
+    glm::vec2 pos;
+    glm::vec3 col;
+};
+
 class Lines
 {
 public:
@@ -11,8 +17,15 @@ public:
     
     void updateProjection(const GLfloat width, const GLfloat height) const;
     
+    // Replace line vertices, e.g., after the board changed
+    void updateLines(const std::vector<LineVertex> &lines);
+    
     void draw() const;
     
+    // Line vertices (two per edge) of a board: regular edges are black,
+    // "boeg" edges white
+    static std::vector<LineVertex> fromEdges(const Graph &board);
+    
     ~Lines();
     
     static const constexpr GLfloat lineWidth = 3.0f;
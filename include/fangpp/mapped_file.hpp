@@ -0,0 +1,71 @@
+#ifndef FANGPP_MAPPED_FILE_HPP
+#define FANGPP_MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+// Read-only memory mapping of an entire file
+class MappedFile {
+public:
+    explicit MappedFile(const char *filename)
+    {
+        const int fd = open(filename, O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open file: " + std::string(filename));
+        }
+        
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to stat file: " + std::string(filename));
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        
+        if (size > 0) {
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);  // Note: mapping stays valid after closing
+        
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Failed to map file: " + std::string(filename));
+        }
+    }
+    
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    
+    ~MappedFile()
+    {
+        if (data != MAP_FAILED && data != nullptr) {
+            munmap(data, size);
+        }
+    }
+    
+    // Pointer to 'count' elements of type T at 'offset', bounds-checked
+    template <typename T>
+    const T *section(const uint64_t offset, const uint64_t count) const
+    {
+        if (offset % alignof(T) != 0 || offset > size ||
+            count > (size - offset) / sizeof(T))
+        {
+            throw std::runtime_error("Corrupt file: section out of bounds");
+        }
+        
+        return reinterpret_cast<const T *>(static_cast<const char *>(data) + offset);
+    }
+    
+    const char *begin() const { return static_cast<const char *>(data); }
+    const char *end() const { return begin() + size; }
+    
+    std::size_t size = 0;
+    void *data = nullptr;
+};
+
+#endif /* FANGPP_MAPPED_FILE_HPP */
@@ -5,6 +5,7 @@
 #include <fangpp/player.hpp>
 
 #include <limits>
+#include <memory>
 
 // Forward-declarations
 class Game;
@@ -69,4 +70,13 @@ private:
     uint32_t m_userClickedPosition = std::numeric_limits<uint32_t>::max();  // invalid
 };
 
+// Strategies a player can be controlled by
+enum StrategyType : uint8_t {
+    STRATEGY_USER = 0,
+    STRATEGY_GREEDY,
+    STRATEGY_AVOIDANT
+};
+
+std::unique_ptr<MoveStrategy> createStrategy(const StrategyType type);
+
 #endif /* FANGPP_MOVE_STRATEGY_HPP */
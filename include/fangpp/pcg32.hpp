@@ -0,0 +1,52 @@
+#ifndef FANGPP_PCG32_HPP
+#define FANGPP_PCG32_HPP
+
+#include <cstdint>
+#include <limits>
+
+// PCG32 (XSH RR) pseudo-random number generator by M. O'Neill. Its whole
+// state is 16 bytes, so it can be copied along with game states (unlike
+// std::mt19937 with its 2.5 KB). Models UniformRandomBitGenerator
+class Pcg32 {
+public:
+    using result_type = uint32_t;
+    
+    Pcg32() { seed(0); }
+    
+    explicit Pcg32(const uint64_t initState, const uint64_t stream = defaultStream)
+    {
+        seed(initState, stream);
+    }
+    
+    void seed(const uint64_t initState, const uint64_t stream = defaultStream)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;  // must be odd
+        (*this)();
+        state += initState;
+        (*this)();
+    }
+    
+    result_type operator()()
+    {
+        const uint64_t oldState = state;
+        state = oldState * multiplier + increment;
+        const uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18) ^ oldState) >> 27);
+        const uint32_t rotation = static_cast<uint32_t>(oldState >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+    
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+    
+    bool operator==(const Pcg32 &other) const = default;
+
+private:
+    static constexpr uint64_t multiplier = 6364136223846793005ULL;
+    static constexpr uint64_t defaultStream = 0xda3e39cb94b95bdbULL;
+    
+    uint64_t state;      // current state of linear congruential generator
+    uint64_t increment;  // selects stream of generator (odd)
+};
+
+#endif /* FANGPP_PCG32_HPP */
@@ -15,10 +15,11 @@ public:
     using const_iterator_t = std::vector<uint32_t>::const_iterator;
         
     Player(uint8_t _id, uint32_t _position, const_iterator_t first, const_iterator_t last, 
-        MoveStrategy *_moveStrategy, GraphQuery sQuery, GraphQuery cQuery) :
-            position(_position), activeTargets(first, last), 
-                moveStrategy(_moveStrategy), id(_id), startQuery(sQuery),
-                    candidateQuery(cQuery) {}
+        std::unique_ptr<MoveStrategy> _moveStrategy) :
+            position(_position), targets(first, last), activeTargets(first, last), 
+                moveStrategy(std::move(_moveStrategy)), id(_id) {}
+    
+    Player(Player &&) = default;
     
     std::vector<uint32_t> makeMove(Game &state, const uint32_t diceRoll);
     
@@ -26,12 +27,15 @@ public:
     
     uint8_t getId() const { return id; }
     
-    GraphQuery &getStartQuery() { return startQuery; }
-    GraphQuery &getCandidateQuery() { return candidateQuery; }
-    
     void setPosition(const uint32_t newPosition) { position = newPosition; }
     
-    const std::unordered_set<uint32_t> &getActiveTargets() const { return activeTargets; }
+    // Targets left to visit, in the order they were dealt
+    const std::vector<uint32_t> &getActiveTargets() const { return activeTargets; }
+    
+    // Bit i is set if the i-th dealt target is left to visit
+    uint32_t getActiveTargetMask() const;
+    
+    void setActiveTargetMask(const uint32_t mask);
     
     bool isBoeg(const Game &state) const;
     
@@ -40,13 +44,15 @@ public:
     bool checkVisitTarget(const uint32_t candidate) 
     { 
         // Try removing candidate position. If successful, return true
-        const std::size_t nRemoved = activeTargets.erase(candidate);
-        return nRemoved == 1;
+        const auto it = std::find(activeTargets.begin(), activeTargets.end(), candidate);
+        if (it == activeTargets.end()) return false;
+        activeTargets.erase(it);
+        return true;
     }
     
     bool isActiveTarget(const uint32_t candidate) const
     {
-        return activeTargets.contains(candidate);
+        return std::find(activeTargets.begin(), activeTargets.end(), candidate) != activeTargets.end();
     }
     
     // Returns true if this player is controlled by the user of this program
@@ -64,11 +70,10 @@ public:
     
 private:   
     uint32_t position;  // current position (vertex index) of player
-    std::unordered_set<uint32_t> activeTargets;  // set of player targets left to visit
-    MoveStrategy *moveStrategy;  // move-making strategy of player (owned)
+    std::vector<uint32_t> targets;  // targets dealt to player
+    std::vector<uint32_t> activeTargets;  // player targets left to visit
+    std::unique_ptr<MoveStrategy> moveStrategy;  // move-making strategy of player
     const uint8_t id;  // unique number identifying this player
-    GraphQuery startQuery;  // Used to query shortest distances from starting position
-    GraphQuery candidateQuery;  // Used to query shortest distances from candidate position
 };
 
 #endif /* FANGPP_PLAYER_HPP */
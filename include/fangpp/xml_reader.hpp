@@ -0,0 +1,78 @@
+#ifndef FANGPP_XML_READER_HPP
+#define FANGPP_XML_READER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+// Minimal streaming (pull) XML reader operating on an in-memory buffer, e.g.,
+// a memory-mapped file. Element names, attributes and text are returned as
+// views into the buffer, so no DOM is ever built. Supports the subset of XML
+// used by GraphML files: elements, attributes, character data, CDATA
+// sections and the predefined/numeric entities. Comments, processing
+// instructions and DOCTYPE declarations are skipped. Start and end tags are
+// checked to match
+class XmlReader {
+public:
+    enum Event {
+        START_ELEMENT = 0,  // <name ...> or <name .../>
+        END_ELEMENT,        // </name> (also emitted for <name .../>)
+        TEXT,               // character data between tags
+        END_OF_DOCUMENT
+    };
+    
+    XmlReader(const char *_begin, const char *_end) : 
+        begin(_begin), cur(_begin), end(_end) {}
+    
+    // Advance to next event
+    Event next();
+    
+    // Name of current element (START_ELEMENT, END_ELEMENT)
+    std::string_view getName() const { return name; }
+    
+    // Raw (undecoded) value of attribute of current element (START_ELEMENT)
+    std::optional<std::string_view> getAttribute(std::string_view attrName) const;
+    
+    // Append (decoded) character data of current TEXT event to 'out'
+    void appendText(std::string &out) const;
+    
+    // Resolve entity references (&amp;, &#65;, ...) in 'raw' and append to 'out'
+    void appendDecoded(std::string_view raw, std::string &out) const;
+    
+    [[noreturn]] void error(const std::string &message) const;
+
+private:
+    struct Attribute {
+        std::string_view name;
+        std::string_view value;
+    };
+    
+    bool startsWith(std::string_view prefix) const
+    {
+        return static_cast<std::size_t>(end - cur) >= prefix.size() &&
+               std::string_view(cur, prefix.size()) == prefix;
+    }
+    
+    // Move past the next occurrence of 'terminator'
+    void skipPast(std::string_view terminator);
+    
+    void skipWhitespace();
+    
+    std::string_view parseName();
+    
+    Event parseStartElement();
+    
+    const char *begin;   // start of buffer (for line numbers in errors)
+    const char *cur;     // current position in buffer
+    const char *end;     // end of buffer
+    std::string_view name;  // current element name
+    std::string_view text;  // current character data
+    bool isTextRaw = false;       // current character data is a CDATA section
+    bool isEndPending = false;    // emit END_ELEMENT for self-closing element next
+    std::vector<Attribute> attributes;  // attributes of current element (capacity reused)
+    std::vector<std::string_view> openElements;  // names of enclosing elements
+};
+
+#endif /* FANGPP_XML_READER_HPP */
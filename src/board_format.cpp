@@ -0,0 +1,188 @@
+#include <fangpp/graph.hpp>
+#include <fangpp/board_format.hpp>
+#include <fangpp/mapped_file.hpp>
+
+#include <cstring>
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+// Round up to next multiple of 8 (section alignment)
+uint64_t alignSection(const uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+}  // namespace
+
+void Graph::loadBinary(const MappedFile &file)
+{
+    const BoardFileHeader &header = *file.section<BoardFileHeader>(0, 1);
+    if (std::memcmp(header.magic, boardFileMagic, sizeof(boardFileMagic)) != 0) {
+        throw std::runtime_error("Not a compiled board file");
+    }
+    if (header.version != boardFileVersion) {
+        throw std::runtime_error("Unsupported board file version " +
+            std::to_string(header.version) + " (expected " +
+            std::to_string(boardFileVersion) + ")");
+    }
+    if (header.graphType != GRAPH_DIRECTED && header.graphType != GRAPH_UNDIRECTED) {
+        throw std::runtime_error("Corrupt board file: invalid graph type");
+    }
+    
+    graphType = static_cast<GRAPH_TYPE>(header.graphType);
+    nVertices = header.nVertices;
+    nEdges = header.nEdges;
+    
+    // Copy sections verbatim; only validate what later code relies on
+    const uint32_t *fileOffsets = file.section<uint32_t>(header.offsetsOffset, nVertices + uint64_t(1));
+    offsets.assign(fileOffsets, fileOffsets + nVertices + 1);
+    if (offsets.front() != 0 || offsets.back() != nEdges ||
+        !std::is_sorted(offsets.begin(), offsets.end()))
+    {
+        throw std::runtime_error("Corrupt board file: invalid CSR offsets");
+    }
+    
+    const uint32_t *fileRegularEnds = file.section<uint32_t>(header.regularEndsOffset, nVertices);
+    regularEnds.assign(fileRegularEnds, fileRegularEnds + nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        if (regularEnds[v] < offsets[v] || regularEnds[v] > offsets[v + 1]) {
+            throw std::runtime_error("Corrupt board file: invalid CSR offsets");
+        }
+    }
+    
+    nborEnds.assign(offsets.begin() + 1, offsets.end());
+    
+    const uint32_t *fileNbors = file.section<uint32_t>(header.edgesOffset, nEdges);
+    nbors.assign(fileNbors, fileNbors + nEdges);
+    for (const uint32_t n : nbors) {
+        if (n >= nVertices) {
+            throw std::runtime_error("Corrupt board file: invalid edge");
+        }
+    }
+    
+    weights.clear();
+    maxWeight = 1;
+    if (header.weightsOffset != 0) {
+        const uint8_t *fileWeights = file.section<uint8_t>(header.weightsOffset, nEdges);
+        weights.assign(fileWeights, fileWeights + nEdges);
+        for (const uint8_t weight : weights) {
+            if (weight < 1 || weight > maxEdgeWeight) {
+                throw std::runtime_error("Corrupt board file: invalid edge weight");
+            }
+            maxWeight = std::max<uint32_t>(maxWeight, weight);
+        }
+    }
+    
+    const char *strings = file.section<char>(header.stringsOffset, header.stringTableSize);
+    const BoardFileVertex *fileVertices = file.section<BoardFileVertex>(header.verticesOffset, nVertices);
+    vertices.resize(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const BoardFileVertex &fileVertex = fileVertices[v];
+        if (uint64_t(fileVertex.nameOffset) + fileVertex.nameLength > header.stringTableSize) {
+            throw std::runtime_error("Corrupt board file: invalid location name");
+        }
+        
+        Vertex &vert = vertices[v];
+        vert.location.assign(strings + fileVertex.nameOffset, fileVertex.nameLength);
+        vert.xpos = fileVertex.xpos;
+        vert.ypos = fileVertex.ypos;
+        vert.isTarget = fileVertex.isTarget;
+    }
+    
+    const uint32_t *fileTargets = file.section<uint32_t>(header.targetsOffset, header.nTargets);
+    targetVertices.assign(fileTargets, fileTargets + header.nTargets);
+    const uint32_t *fileStations = file.section<uint32_t>(header.stationsOffset, header.nStations);
+    stationVertices.assign(fileStations, fileStations + header.nStations);
+    for (const uint32_t v : targetVertices) {
+        if (v >= nVertices) throw std::runtime_error("Corrupt board file: invalid target");
+    }
+    for (const uint32_t v : stationVertices) {
+        if (v >= nVertices) throw std::runtime_error("Corrupt board file: invalid station");
+    }
+}
+
+void Graph::writeBinary(const char *boardFile) const
+{
+    // Build string table and on-disk vertices
+    std::string strings;
+    std::vector<BoardFileVertex> fileVertices(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const Vertex &vert = vertices[v];
+        
+        BoardFileVertex &fileVertex = fileVertices[v];
+        std::memset(&fileVertex, 0, sizeof(fileVertex));
+        fileVertex.nameOffset = static_cast<uint32_t>(strings.size());
+        fileVertex.nameLength = static_cast<uint32_t>(vert.location.size());
+        fileVertex.xpos = vert.xpos;
+        fileVertex.ypos = vert.ypos;
+        fileVertex.isTarget = vert.isTarget;
+        
+        strings += vert.location;
+    }
+    
+    // Note: Free slots left in the neighbor lists by edge edits are not
+    //       written, the file stores packed lists
+    std::vector<uint32_t> packedOffsets, packedRegularEnds, packedNborEnds, packedNbors;
+    std::vector<uint8_t> packedWeights;
+    const bool isPacked = (nbors.size() == nEdges);
+    if (!isPacked) {
+        spaceAdjacency(0, packedOffsets, packedRegularEnds, packedNborEnds, packedNbors,
+            packedWeights);
+    }
+    const std::vector<uint32_t> &fileOffsets = (isPacked) ? offsets : packedOffsets;
+    const std::vector<uint32_t> &fileRegularEnds = (isPacked) ? regularEnds : packedRegularEnds;
+    const std::vector<uint32_t> &fileNbors = (isPacked) ? nbors : packedNbors;
+    const std::vector<uint8_t> &fileWeights = (isPacked) ? weights : packedWeights;
+    
+    BoardFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, boardFileMagic, sizeof(boardFileMagic));
+    header.version = boardFileVersion;
+    header.graphType = graphType;
+    header.nVertices = nVertices;
+    header.nEdges = nEdges;
+    header.nTargets = static_cast<uint32_t>(targetVertices.size());
+    header.nStations = static_cast<uint32_t>(stationVertices.size());
+    header.stringTableSize = strings.size();
+    // Lay out sections one after another
+    header.offsetsOffset  = alignSection(sizeof(header));
+    header.regularEndsOffset = alignSection(header.offsetsOffset + fileOffsets.size() * sizeof(uint32_t));
+    header.edgesOffset    = alignSection(header.regularEndsOffset + fileRegularEnds.size() * sizeof(uint32_t));
+    header.verticesOffset = alignSection(header.edgesOffset + fileNbors.size() * sizeof(uint32_t));
+    header.targetsOffset  = alignSection(header.verticesOffset + fileVertices.size() * sizeof(BoardFileVertex));
+    header.stationsOffset = alignSection(header.targetsOffset + targetVertices.size() * sizeof(uint32_t));
+    header.stringsOffset  = alignSection(header.stationsOffset + stationVertices.size() * sizeof(uint32_t));
+    header.weightsOffset  = (fileWeights.empty()) ? 0 : alignSection(header.stringsOffset + strings.size());
+    
+    std::ofstream out(boardFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open board file for writing: " + std::string(boardFile));
+    }
+    
+    const auto writeSection = [&out](const uint64_t offset, const void *data, const std::size_t size)
+    {
+        // Zero padding up to start of section
+        static const char zeros[8] = {};
+        const uint64_t position = static_cast<uint64_t>(out.tellp());
+        out.write(zeros, static_cast<std::streamsize>(offset - position));
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSection(header.offsetsOffset, fileOffsets.data(), fileOffsets.size() * sizeof(uint32_t));
+    writeSection(header.regularEndsOffset, fileRegularEnds.data(), fileRegularEnds.size() * sizeof(uint32_t));
+    writeSection(header.edgesOffset, fileNbors.data(), fileNbors.size() * sizeof(uint32_t));
+    writeSection(header.verticesOffset, fileVertices.data(), fileVertices.size() * sizeof(BoardFileVertex));
+    writeSection(header.targetsOffset, targetVertices.data(), targetVertices.size() * sizeof(uint32_t));
+    writeSection(header.stationsOffset, stationVertices.data(), stationVertices.size() * sizeof(uint32_t));
+    writeSection(header.stringsOffset, strings.data(), strings.size());
+    if (!fileWeights.empty()) {
+        writeSection(header.weightsOffset, fileWeights.data(), fileWeights.size());
+    }
+    
+    if (!out) {
+        throw std::runtime_error("Failed to write board file: " + std::string(boardFile));
+    }
+}
@@ -0,0 +1,440 @@
+#include <fangpp/graph.hpp>
+#include <fangpp/mapped_file.hpp>
+#include <fangpp/xml_reader.hpp>
+
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+// Attributes of vertices/edges understood by the loader
+enum GraphAttribute {
+    ATTR_LOCATION = 0,
+    ATTR_XPOS,
+    ATTR_YPOS,
+    ATTR_TARGET_LOCATION,
+    ATTR_BOEG_EDGE,
+    ATTR_EDGE_WEIGHT,
+    ATTR_UNKNOWN
+};
+
+// Attribute a <key/> resolves to, together with its default value
+struct KeyInfo {
+    GraphAttribute attribute;
+    std::string defaultValue;
+    bool hasDefault;
+};
+
+GraphAttribute getVertexAttribute(std::string_view name)
+{
+    if (name == "location")       return ATTR_LOCATION;
+    if (name == "xpos")           return ATTR_XPOS;
+    if (name == "ypos")           return ATTR_YPOS;
+    if (name == "targetLocation") return ATTR_TARGET_LOCATION;
+    
+    throw std::runtime_error("Unrecognized attribute name: " + std::string(name));
+}
+
+GraphAttribute getEdgeAttribute(std::string_view name)
+{
+    if (name == "boegEdge") return ATTR_BOEG_EDGE;
+    if (name == "weight")   return ATTR_EDGE_WEIGHT;
+    
+    return ATTR_UNKNOWN;  // ignored
+}
+
+float parseFloat(const XmlReader &reader, const std::string &value)
+{
+    float result = 0.0f;
+    const char *first = value.data();
+    const char *last = value.data() + value.size();
+    // Tolerate surrounding whitespace
+    while (first < last && std::isspace(static_cast<unsigned char>(*first))) ++first;
+    while (last > first && std::isspace(static_cast<unsigned char>(last[-1]))) --last;
+    
+    const auto [ptr, ec] = std::from_chars(first, last, result);
+    if (ec != std::errc() || ptr != last) {
+        reader.error("Invalid floating point value '" + value + "'");
+    }
+    
+    return result;
+}
+
+bool parseBool(const std::string &value)
+{
+    return value == "true";
+}
+
+// Dice steps of an edge: an integer in [1, Graph::maxEdgeWeight]
+uint8_t parseWeight(const XmlReader &reader, const std::string &value)
+{
+    uint32_t result = 0;
+    const char *first = value.data();
+    const char *last = value.data() + value.size();
+    // Tolerate surrounding whitespace
+    while (first < last && std::isspace(static_cast<unsigned char>(*first))) ++first;
+    while (last > first && std::isspace(static_cast<unsigned char>(last[-1]))) --last;
+    
+    const auto [ptr, ec] = std::from_chars(first, last, result);
+    if (ec != std::errc() || ptr != last || result < 1 || result > Graph::maxEdgeWeight) {
+        reader.error("Invalid edge weight '" + value + "'");
+    }
+    
+    return static_cast<uint8_t>(result);
+}
+
+void setVertexAttribute(const XmlReader &reader, Vertex &vert,
+    const GraphAttribute attribute, const std::string &value)
+{
+    switch (attribute) {
+        case ATTR_LOCATION:        vert.location = value; break;
+        case ATTR_XPOS:            vert.xpos = parseFloat(reader, value); break;
+        case ATTR_YPOS:            vert.ypos = parseFloat(reader, value); break;
+        case ATTR_TARGET_LOCATION: vert.isTarget = parseBool(value); break;
+        default: break;
+    }
+}
+
+}  // namespace
+
+// Reads the (memory-mapped) file in two passes straight into the CSR
+// arrays. The first pass reads keys and vertices and counts the regular and
+// Boeg-only degree of every vertex, the second one resumes at the first edge
+// and places each edge in the slots these degrees reserve. Key and vertex
+// ids are resolved through hash tables of views into the mapped file, so
+// ids are never copied and no edge list is built
+void Graph::loadGraphML(const MappedFile &file)
+{
+    // Key id -> attribute (and default), separately for vertices and edges
+    std::unordered_map<std::string_view, KeyInfo> vertexKeys;
+    std::unordered_map<std::string_view, KeyInfo> edgeKeys;
+    
+    // Vertex referred to by a node or edge element. Edges may refer to
+    // vertices declared later, whose index is only known after the first
+    // pass. Until then, the builder counts edges by the order of first
+    // reference
+    // Note: Typically nodes have ids 'nx' where x is the node index,
+    //       however this does not always have to be the case
+    struct VertexEntry {
+        uint32_t id = 0;  // CSRBuilder id
+        uint32_t index = std::numeric_limits<uint32_t>::max();  // none declared yet
+    };
+    std::unordered_map<std::string_view, VertexEntry> vertexEntries;
+    const auto entryOf = [&vertexEntries](const std::string_view id) -> VertexEntry &
+    {
+        const auto [it, isNew] = vertexEntries.try_emplace(id);
+        if (isNew) it->second.id = static_cast<uint32_t>(vertexEntries.size() - 1);
+        
+        return it->second;
+    };
+    
+    // Vertex/edge with all attributes set to their defaults
+    Vertex defaultVertex{};
+    uint8_t defaultIsBoegOnly = 0;
+    uint8_t defaultWeight = 1;
+    
+    // Reader at the first edge, where the second pass starts
+    std::optional<XmlReader> edgeReader;
+    
+    nVertices = 0;
+    
+    // Count vertex degrees (first pass) or fill neighbor arrays (second pass)
+    const auto scan = [&](XmlReader &reader, CSRBuilder::EdgeSink &sink)
+    {
+        const bool isFillPass = sink.isFilling();
+        enum Context { CONTEXT_NONE, CONTEXT_KEY, CONTEXT_NODE, CONTEXT_EDGE };
+        Context context = CONTEXT_NONE;
+        
+        bool isGraphmlFound = isFillPass;
+        bool isGraphFound = isFillPass;
+        bool isGraphDone = false;
+        
+        // State of element currently being processed
+        std::string_view keyId;
+        std::unordered_map<std::string_view, KeyInfo> *keyMap = nullptr;
+        KeyInfo keyInfo{};
+        Vertex vert{};
+        VertexEntry *vertexEntry = nullptr;  // null if node is ignored
+        uint8_t isBoegOnly = 0;
+        uint8_t weight = 1;
+        std::string_view edgeSource, edgeTarget;
+        // Text content of current <data/> or <default/> element
+        const KeyInfo *dataKey = nullptr;
+        bool isCollectingText = false;
+        std::string text;
+        
+        const auto applyDefaults = [&]()
+        {
+            for (const auto &[id, info] : vertexKeys) {
+                if (info.hasDefault) setVertexAttribute(reader, defaultVertex, info.attribute, info.defaultValue);
+            }
+            for (const auto &[id, info] : edgeKeys) {
+                if (info.hasDefault && info.attribute == ATTR_BOEG_EDGE) {
+                    defaultIsBoegOnly = parseBool(info.defaultValue);
+                } else if (info.hasDefault && info.attribute == ATTR_EDGE_WEIGHT) {
+                    defaultWeight = parseWeight(reader, info.defaultValue);
+                }
+            }
+        };
+        
+        const auto requireAttribute = [&reader](std::string_view attrName, const char *message)
+        {
+            const auto value = reader.getAttribute(attrName);
+            if (!value) { throw std::runtime_error(message); }
+            
+            return *value;
+        };
+        
+        // Note: The second pass starts with the first edge element, which the
+        //       reader it copied has read already
+        for (auto event = (isFillPass) ? XmlReader::START_ELEMENT : reader.next();
+             event != XmlReader::END_OF_DOCUMENT && !isGraphDone;
+             event = reader.next())
+        {
+            if (event == XmlReader::TEXT) {
+                if (isCollectingText) reader.appendText(text);
+                continue;
+            }
+            
+            const std::string_view name = reader.getName();
+            
+            if (event == XmlReader::START_ELEMENT) {
+                if (!isGraphmlFound) {
+                    if (name != "graphml") { throw std::runtime_error("Not a valid GraphML file"); }
+                    isGraphmlFound = true;
+                } else if (name == "key" && !isFillPass) {
+                    keyId = requireAttribute("id", "Failed to fetch id of key");
+                    const auto attrName = requireAttribute("attr.name", "Failed to fetch attr.name of key");
+                    const auto attrType = requireAttribute("for", "Failed to fetch which primitive key is for");
+                    
+                    if (attrType == "node") {
+                        keyMap = &vertexKeys;
+                        keyInfo = {getVertexAttribute(attrName), "", false};
+                    } else if (attrType == "edge") {
+                        keyMap = &edgeKeys;
+                        keyInfo = {getEdgeAttribute(attrName), "", false};
+                    } else {
+                        std::cerr << "Warning: key specified for neither node "
+                                    << "nor edge. Ignoring...\n";
+                        keyMap = nullptr;
+                    }
+                    context = CONTEXT_KEY;
+                } else if (name == "default" && context == CONTEXT_KEY) {
+                    text.clear();
+                    isCollectingText = true;
+                } else if (name == "graph") {
+                    // Determine type of graph
+                    const auto edgeType = requireAttribute("edgedefault", "Missing edge type (default)");
+                    if (edgeType == "undirected") {
+                        graphType = GRAPH_UNDIRECTED;
+                    } else if (edgeType == "directed") {
+                        graphType = GRAPH_DIRECTED;
+                    } else {
+                        throw std::runtime_error("Unrecognized edge type. So far "
+                            "only 'undirected' or 'directed' are supported");
+                    }
+                    isGraphFound = true;
+                    if (!isFillPass) applyDefaults();  // all keys precede the graph
+                } else if (name == "node" && isGraphFound && !isFillPass) {
+                    const auto id = requireAttribute("id", "Failed to fetch id of node");
+                    vertexEntry = &entryOf(id);
+                    if (vertexEntry->index != std::numeric_limits<uint32_t>::max()) {
+                        std::cerr << "Warning: Duplicate vertex id = " << id
+                                    << " encountered. Ignored...\n";
+                        vertexEntry = nullptr;
+                    }
+                    vert = defaultVertex;
+                    context = CONTEXT_NODE;
+                } else if (name == "edge" && isGraphFound) {
+                    if (!edgeReader) edgeReader = reader;
+                    edgeSource = requireAttribute("source", "Missing source vertex for edge");
+                    edgeTarget = requireAttribute("target", "Missing target vertex for edge");
+                    isBoegOnly = defaultIsBoegOnly;
+                    weight = defaultWeight;
+                    context = CONTEXT_EDGE;
+                } else if (name == "data" && (context == CONTEXT_NODE || context == CONTEXT_EDGE)) {
+                    const auto key = reader.getAttribute("key");
+                    const auto &keys = (context == CONTEXT_NODE) ? vertexKeys : edgeKeys;
+                    const auto it = key ? keys.find(*key) : keys.end();
+                    dataKey = (it != keys.end()) ? &it->second : nullptr;
+                    text.clear();
+                    isCollectingText = true;
+                }
+            } else {  // XmlReader::END_ELEMENT
+                if (name == "key" && context == CONTEXT_KEY) {
+                    if (keyMap) (*keyMap)[keyId] = keyInfo;
+                    context = CONTEXT_NONE;
+                } else if (name == "default" && context == CONTEXT_KEY) {
+                    keyInfo.defaultValue = text;
+                    keyInfo.hasDefault = true;
+                    isCollectingText = false;
+                } else if (name == "data" && isCollectingText) {
+                    if (dataKey && context == CONTEXT_NODE) {
+                        setVertexAttribute(reader, vert, dataKey->attribute, text);
+                    } else if (dataKey && context == CONTEXT_EDGE && dataKey->attribute == ATTR_BOEG_EDGE) {
+                        isBoegOnly = parseBool(text);
+                    } else if (dataKey && context == CONTEXT_EDGE && dataKey->attribute == ATTR_EDGE_WEIGHT) {
+                        weight = parseWeight(reader, text);
+                    }
+                    isCollectingText = false;
+                } else if (name == "node" && context == CONTEXT_NODE) {
+                    if (vertexEntry) {
+                        vertexEntry->index = nVertices;
+                        if (vert.isTarget) {
+                            targetVertices.push_back(nVertices);
+                        } else {
+                            stationVertices.push_back(nVertices);
+                        }
+                        vertices.push_back(std::move(vert));
+                        ++nVertices;
+                    }
+                    context = CONTEXT_NONE;
+                } else if (name == "edge" && context == CONTEXT_EDGE) {
+                    const uint32_t source = entryOf(edgeSource).id;
+                    const uint32_t target = entryOf(edgeTarget).id;
+                    sink.add(source, target, isBoegOnly, weight);
+                    if (graphType == GRAPH_UNDIRECTED) {
+                        // Also add edge going in opposite direction
+                        sink.add(target, source, isBoegOnly, weight);
+                    }
+                    context = CONTEXT_NONE;
+                } else if (name == "graph") {
+                    // Note: Assumes there is only one graph. Ignores any potential
+                    //       graphs defined later.
+                    isGraphDone = true;
+                }
+            }
+        }
+        
+        if (!isGraphmlFound) { throw std::runtime_error("Not a valid GraphML file"); }
+        if (!isGraphFound) { throw std::runtime_error("Missing 'graph' attribute"); }
+    };
+    
+    XmlReader reader(file.begin(), file.end());
+    setAdjacency(CSRBuilder().build(
+        [&](CSRBuilder::EdgeSink &sink)
+        {
+            if (!sink.isFilling()) {
+                scan(reader, sink);
+            } else if (edgeReader) {
+                scan(*edgeReader, sink);
+            }
+        },
+        [&](std::vector<uint32_t> &vertexIndexes)
+        {
+            vertexIndexes.resize(vertexEntries.size());
+            for (const auto &[id, entry] : vertexEntries) {
+                if (entry.index == std::numeric_limits<uint32_t>::max()) {
+                    throw std::runtime_error("Invalid vertex id '" + std::string(id) + "' for edge");
+                }
+                vertexIndexes[entry.id] = entry.index;
+            }
+            
+            return nVertices;
+        }));
+    
+    // De-allocate unnecessary capacity
+    vertices.shrink_to_fit();
+    targetVertices.shrink_to_fit();
+    stationVertices.shrink_to_fit();
+}
+
+namespace {
+
+void writeEscaped(std::ofstream &out, std::string_view text)
+{
+    for (const char c : text) {
+        switch (c) {
+            case '&': out << "&amp;"; break;
+            case '<': out << "&lt;"; break;
+            case '>': out << "&gt;"; break;
+            case '"': out << "&quot;"; break;
+            case '\'': out << "&apos;"; break;
+            default: out << c; break;
+        }
+    }
+}
+
+// Shortest representation that reads back to the same float
+void writeFloat(std::ofstream &out, const float value)
+{
+    char buffer[32];
+    const auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.write(buffer, ptr - buffer);
+}
+
+}  // namespace
+
+void Graph::writeGraphML(const char *graphFile) const
+{
+    std::ofstream out(graphFile, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open board file for writing: " + std::string(graphFile));
+    }
+    
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+        << "    <key id=\"d0\" for=\"node\" attr.name=\"location\" attr.type=\"string\"/>\n"
+        << "    <key id=\"d1\" for=\"node\" attr.name=\"xpos\" attr.type=\"float\"/>\n"
+        << "    <key id=\"d2\" for=\"node\" attr.name=\"ypos\" attr.type=\"float\"/>\n"
+        << "    <key id=\"d3\" for=\"node\" attr.name=\"targetLocation\" attr.type=\"boolean\">\n"
+        << "        <default>false</default>\n"
+        << "    </key>\n"
+        << "    <key id=\"d4\" for=\"edge\" attr.name=\"boegEdge\" attr.type=\"boolean\">\n"
+        << "        <default>false</default>\n"
+        << "    </key>\n"
+        << "    <key id=\"d5\" for=\"edge\" attr.name=\"weight\" attr.type=\"int\">\n"
+        << "        <default>1</default>\n"
+        << "    </key>\n"
+        << "    <graph id=\"G\" edgedefault=\""
+        << ((graphType == GRAPH_UNDIRECTED) ? "undirected" : "directed") << "\">\n";
+    
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const Vertex &vert = vertices[v];
+        out << "        <node id=\"n" << v << "\">\n"
+            << "            <data key=\"d0\">";
+        writeEscaped(out, vert.location);
+        out << "</data>\n"
+            << "            <data key=\"d1\">";
+        writeFloat(out, vert.xpos);
+        out << "</data>\n"
+            << "            <data key=\"d2\">";
+        writeFloat(out, vert.ypos);
+        out << "</data>\n";
+        if (vert.isTarget) {
+            out << "            <data key=\"d3\">true</data>\n";
+        }
+        out << "        </node>\n";
+    }
+    
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+            const uint32_t n = nbors[i];
+            if (graphType == GRAPH_UNDIRECTED && v > n) {
+                continue;  // already written in opposite direction
+            }
+            
+            out << "        <edge source=\"n" << v << "\" target=\"n" << n << '"';
+            const bool isBoegOnly = (i >= regularEnds[v]);
+            const uint32_t weight = edgeWeight(i);
+            if (isBoegOnly || weight != 1) {
+                out << ">\n";
+                if (isBoegOnly) out << "            <data key=\"d4\">true</data>\n";
+                if (weight != 1) out << "            <data key=\"d5\">" << weight << "</data>\n";
+                out << "        </edge>\n";
+            } else {
+                out << "/>\n";
+            }
+        }
+    }
+    
+    out << "    </graph>\n"
+        << "</graphml>\n";
+    
+    if (!out) {
+        throw std::runtime_error("Failed to write board file: " + std::string(graphFile));
+    }
+}
@@ -0,0 +1,63 @@
+#include <fangpp/board_registry.hpp>
+#include <fangpp/mapped_file.hpp>
+
+#include <filesystem>
+
+std::shared_ptr<const Graph> BoardRegistry::acquire(const char *boardFile)
+{
+    const std::string path = std::filesystem::weakly_canonical(boardFile).string();
+    // Note: The board is parsed from the very mapping that is hashed, so the
+    //       hash describes the loaded contents even if the file is replaced
+    //       meanwhile
+    const MappedFile file(boardFile);
+    const uint64_t hash = hashFile(file);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // Forget boards no game uses anymore
+    std::erase_if(boards, [](const auto &entry) { return entry.second.board.expired(); });
+    
+    const auto it = boards.find(path);
+    if (it != boards.end() && it->second.hash == hash) {
+        if (std::shared_ptr<const Graph> board = it->second.board.lock()) return board;
+    }
+    
+    // Note: Loading under the lock keeps concurrent requests from loading
+    //       the same file twice
+    auto board = std::make_shared<Graph>(file, boardFile);
+    // Turn AI shortest path queries into table lookups (no-op for large boards)
+    board->precomputeDistanceTables();
+    // Answer them from hub labels on boards too large for tables instead
+    if (isDistanceOracleEnabled && !board->hasDistanceTables()) {
+        board->precomputeDistanceOracle();
+    }
+    // Turn dice roll reachability queries into lookups (no-op for large boards)
+    board->precomputeReachabilityIndex();
+    
+    boards[path] = {hash, board};
+    
+    return board;
+}
+
+BoardRegistry &BoardRegistry::global()
+{
+    static BoardRegistry registry;
+    
+    return registry;
+}
+
+uint64_t BoardRegistry::hashFile(const char *boardFile)
+{
+    return hashFile(MappedFile(boardFile));
+}
+
+uint64_t BoardRegistry::hashFile(const MappedFile &file)
+{
+    uint64_t hash = 0xcbf29ce484222325;  // FNV offset basis
+    for (const char c : file) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;  // FNV prime
+    }
+    
+    return hash;
+}
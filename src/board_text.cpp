@@ -0,0 +1,202 @@
+#include <fangpp/graph.hpp>
+#include <fangpp/mapped_file.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+// Plain-text edge list format:
+//
+//   u                 graph type ('u'ndirected or 'd'irected)
+//   16                number of vertices
+//   1                 optional list of target vertex ids, one per line
+//   12
+//
+//   0 1 0             one edge per line: source, target, optional Boeg
+//   0 3 1             flag (1 if edge is accessible only to the Boeg) and
+//   3 4 0 2           optional weight (dice steps of the edge, default 1)
+//
+// Blank lines are ignored. Lines holding a single number are targets, lines
+// holding two to four numbers are edges
+// Note: Names and positions of vertices are not stored
+
+namespace {
+
+// Splits a memory range into lines of unsigned integers without allocating
+class TextTokenizer {
+public:
+    TextTokenizer(const char *_cur, const char *_end) : cur(_cur), end(_end) {}
+    
+    // Skips blank lines. Returns false if there are no more lines
+    bool nextLine()
+    {
+        while (cur < end && (*cur == '\n' || *cur == '\r' || *cur == ' ' || *cur == '\t')) {
+            if (*cur == '\n') ++lineNumber;
+            ++cur;
+        }
+        
+        return cur < end;
+    }
+    
+    // Parses up to 'maxCount' numbers of the current line and moves to the
+    // next one. Returns the number of parsed values
+    uint32_t parseNumbers(uint32_t *values, const uint32_t maxCount)
+    {
+        uint32_t count = 0;
+        while (true) {
+            skipBlanks();
+            if (cur == end || *cur == '\n' || *cur == '\r') break;
+            
+            if (count == maxCount) error("too many values");
+            
+            if (*cur < '0' || *cur > '9') error("expected number");
+            uint64_t value = 0;
+            while (cur < end && *cur >= '0' && *cur <= '9') {
+                value = 10 * value + static_cast<uint64_t>(*cur - '0');
+                if (value > UINT32_MAX) error("number out of range");
+                ++cur;
+            }
+            values[count++] = static_cast<uint32_t>(value);
+        }
+        
+        return count;
+    }
+    
+    // Parses a single character token and moves to the next line
+    char parseChar()
+    {
+        skipBlanks();
+        if (cur == end) error("unexpected end of file");
+        
+        const char c = *cur++;
+        skipBlanks();
+        if (cur < end && *cur != '\n' && *cur != '\r') error("expected single character");
+        
+        return c;
+    }
+    
+    [[noreturn]] void error(const char *message) const
+    {
+        throw std::runtime_error("Parse error in line " + 
+            std::to_string(lineNumber) + ": " + message);
+    }
+
+private:
+    void skipBlanks()
+    {
+        while (cur < end && (*cur == ' ' || *cur == '\t')) ++cur;
+    }
+    
+    const char *cur;
+    const char *end;
+    uint32_t lineNumber = 1;
+};
+
+}  // namespace
+
+void Graph::loadText(const MappedFile &file)
+{
+    TextTokenizer tokenizer(file.begin(), file.end());
+    
+    if (!tokenizer.nextLine()) tokenizer.error("missing graph type");
+    const char type = tokenizer.parseChar();
+    if (type == 'u') {
+        graphType = GRAPH_UNDIRECTED;
+    } else if (type == 'd') {
+        graphType = GRAPH_DIRECTED;
+    } else {
+        tokenizer.error("unrecognized graph type (expected 'u' or 'd')");
+    }
+    
+    uint32_t values[4];
+    if (!tokenizer.nextLine() || tokenizer.parseNumbers(values, 1) != 1) {
+        tokenizer.error("missing number of vertices");
+    }
+    nVertices = values[0];
+    
+    std::vector<uint8_t> isTarget(nVertices, 0);
+    // Note: Preallocate for typical boards of average degree ~3 to avoid
+    //       repeated reallocations
+    std::vector<uint32_t> edgeSources, edgeTargets;
+    std::vector<uint8_t> edgeBoegFlags, edgeWeights;
+    edgeSources.reserve(2 * static_cast<std::size_t>(nVertices));
+    edgeTargets.reserve(2 * static_cast<std::size_t>(nVertices));
+    edgeBoegFlags.reserve(2 * static_cast<std::size_t>(nVertices));
+    edgeWeights.reserve(2 * static_cast<std::size_t>(nVertices));
+    
+    while (tokenizer.nextLine()) {
+        const uint32_t count = tokenizer.parseNumbers(values, 4);
+        if (values[0] >= nVertices || (count > 1 && values[1] >= nVertices)) {
+            tokenizer.error("invalid vertex id");
+        }
+        
+        if (count == 1) {
+            // Note: Duplicate targets are ignored
+            isTarget[values[0]] = 1;
+        } else {
+            const uint32_t boegFlag = (count >= 3) ? values[2] : 0;
+            if (boegFlag > 1) tokenizer.error("invalid Boeg flag");
+            const uint32_t weight = (count == 4) ? values[3] : 1;
+            if (weight < 1 || weight > maxEdgeWeight) tokenizer.error("invalid edge weight");
+            
+            edgeSources.push_back(values[0]);
+            edgeTargets.push_back(values[1]);
+            edgeBoegFlags.push_back(static_cast<uint8_t>(boegFlag));
+            edgeWeights.push_back(static_cast<uint8_t>(weight));
+        }
+    }
+    
+    // The format has no names or positions; place vertices on a circle
+    vertices.resize(nVertices);
+    const float angleIncrement = 2.0f * static_cast<float>(M_PI) / std::max(nVertices, 1u);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        Vertex &vert = vertices[v];
+        vert.location = std::to_string(v);
+        vert.xpos = 0.9f * std::cos(v * angleIncrement);
+        vert.ypos = 0.9f * std::sin(v * angleIncrement);
+        vert.isTarget = isTarget[v];
+        
+        if (vert.isTarget) {
+            targetVertices.push_back(v);
+        } else {
+            stationVertices.push_back(v);
+        }
+    }
+    
+    buildAdjacency(edgeSources, edgeTargets, edgeBoegFlags, edgeWeights);
+}
+
+void Graph::writeText(const char *boardFile) const
+{
+    std::ofstream out(boardFile, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open board file for writing: " + std::string(boardFile));
+    }
+    
+    out << ((graphType == GRAPH_UNDIRECTED) ? 'u' : 'd') << '\n' << nVertices << '\n';
+    for (const uint32_t v : targetVertices) {
+        out << v << '\n';
+    }
+    out << '\n';
+    
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+            const uint32_t n = nbors[i];
+            if (graphType == GRAPH_UNDIRECTED && v > n) {
+                continue;  // already written in opposite direction
+            }
+            
+            const uint32_t weight = edgeWeight(i);
+            out << v << ' ' << n;
+            if (weight != 1) {
+                out << ' ' << (i >= regularEnds[v]) << ' ' << weight;
+            } else if (i >= regularEnds[v]) {
+                out << " 1";  // Boeg-only edge
+            }
+            out << '\n';
+        }
+    }
+    
+    if (!out) {
+        throw std::runtime_error("Failed to write board file: " + std::string(boardFile));
+    }
+}
@@ -23,20 +23,7 @@ Circles::Circles(const std::vector<Vertex> &vertices) : nInstances(vertices.size
         );
     }
     
-    // Define static circle colors: Black for station vertices and
-    // magenta for target vertices
-    std::vector<glm::vec3> instanceColors(vertices.size());
-    for (uint32_t i = 0; i < vertices.size(); ++i)
-    {
-        if (vertices[i].isTarget)
-        {
-            instanceColors[i] = glm::vec3(1.f, 92.f/255.f, 244.f/255.f);  // pink
-        }
-        else
-        {
-            instanceColors[i] = glm::vec3(0.0f);  // black
-        }
-    }
+    const std::vector<glm::vec3> instanceColors = computeInstanceColors(vertices);
     
     CHKERRGL(glUseProgram(shaderProgram));
     {
@@ -109,6 +96,70 @@ Circles::Circles(const std::vector<Vertex> &vertices) : nInstances(vertices.size
     CHKERRGL(glUseProgram(0));
 }
 
+std::vector<glm::vec3> Circles::computeInstanceColors(const std::vector<Vertex> &vertices)
+{
+    // Define static circle colors: Black for station vertices and
+    // magenta for target vertices
+    std::vector<glm::vec3> instanceColors(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); ++i)
+    {
+        if (vertices[i].isTarget)
+        {
+            instanceColors[i] = glm::vec3(1.f, 92.f/255.f, 244.f/255.f);  // pink
+        }
+        else
+        {
+            instanceColors[i] = glm::vec3(0.0f);  // black
+        }
+    }
+    
+    return instanceColors;
+}
+
+void Circles::updateVertices(const std::vector<Vertex> &vertices)
+{
+    const std::vector<glm::vec3> instanceColors = computeInstanceColors(vertices);
+    // Note: Buffers of the same size are overwritten in place, otherwise
+    //       reallocated (the VAO keeps referring to the same buffers)
+    const bool isSameSize = vertices.size() == nInstances;
+    nInstances = vertices.size();
+    
+    CHKERRGL(glBindBuffer(GL_ARRAY_BUFFER, vboCirclesInstancePos));
+    if (isSameSize)
+    {
+        CHKERRGL(glBufferSubData(GL_ARRAY_BUFFER, 0,
+                                 vertices.size() * sizeof(vertices[0]),
+                                 vertices.data()
+        ));
+    }
+    else
+    {
+        CHKERRGL(glBufferData(GL_ARRAY_BUFFER,
+                              vertices.size() * sizeof(vertices[0]),
+                              vertices.data(),
+                              GL_STATIC_DRAW
+        ));
+    }
+    
+    CHKERRGL(glBindBuffer(GL_ARRAY_BUFFER, vboCirclesInstanceColor));
+    if (isSameSize)
+    {
+        CHKERRGL(glBufferSubData(GL_ARRAY_BUFFER, 0,
+                                 instanceColors.size() * sizeof(instanceColors[0]),
+                                 instanceColors.data()
+        ));
+    }
+    else
+    {
+        CHKERRGL(glBufferData(GL_ARRAY_BUFFER,
+                              instanceColors.size() * sizeof(instanceColors[0]),
+                              instanceColors.data(),
+                              GL_STATIC_DRAW
+        ));
+    }
+    CHKERRGL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
 void Circles::draw() const
 {
     // Use this shader program
@@ -1,27 +1,57 @@
 #include <fangpp/game_state.hpp>
 
 #include <stdexcept>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<GameSnapshot>, "snapshots are copied as plain bytes");
+static_assert(sizeof(GameSnapshot) == 64, "snapshots fit a cache line");
+static_assert(GameSnapshot::maxPlayers + 1 == Player::maxPlayableCharacters,
+              "snapshots hold all playable characters");
 
 Game::Game(const char *boardFile, const uint8_t _nPlayers, 
-    const uint8_t _nTargetsPlayer) :
-        Graph(boardFile), moveOrder(_nPlayers),
-            nTargetsPlayer(_nTargetsPlayer), nPlayers(_nPlayers)
+    const uint8_t _nTargetsPlayer, const uint8_t _nDice /* = 1 */,
+    std::vector<StrategyType> _strategyTypes /* = {} */) :
+        Game(BoardRegistry::global().acquire(boardFile), _nPlayers, _nTargetsPlayer, _nDice,
+            std::move(_strategyTypes)) {}
+
+Game::Game(std::shared_ptr<const Graph> _board, const uint8_t _nPlayers,
+    const uint8_t _nTargetsPlayer, const uint8_t _nDice /* = 1 */,
+    std::vector<StrategyType> _strategyTypes /* = {} */) :
+        board(std::move(_board)), moveOrder(_nPlayers), strategyTypes(std::move(_strategyTypes)),
+            nTargetsPlayer(_nTargetsPlayer), nPlayers(_nPlayers), nDice(_nDice)
 {
     if (nPlayers <= 1) {
         throw std::invalid_argument("Require at least 2 players to play");
     }
     
-    // Note: + 1 for random Boeg initial position
-    const uint8_t minTargets = nPlayers * nTargetsPlayer + 1;
-    if (targetVertices.size() < minTargets) {
-        throw std::runtime_error("Require at least " + 
-            std::to_string(minTargets) + " unique target vertices");
+    if (nPlayers > GameSnapshot::maxPlayers) {
+        throw std::invalid_argument("Require at most " +
+            std::to_string(GameSnapshot::maxPlayers) + " players to play");
     }
     
-    if (stationVertices.size() == 0) {
-        throw std::runtime_error("Require at least 1 non-target vertex");
+    if (nTargetsPlayer > GameSnapshot::maxTargetsPlayer) {
+        throw std::invalid_argument("Require at most " +
+            std::to_string(GameSnapshot::maxTargetsPlayer) + " targets per player");
+    }
+    
+    if (nDice == 0) {
+        throw std::invalid_argument("Require at least 1 die to play");
+    }
+    
+    if (strategyTypes.empty()) {
+        // TODO: For now user is always the first player (red).
+        //       Make user choose or assign a random player to them in the future.
+        strategyTypes.assign(nPlayers, STRATEGY_AVOIDANT);
+        strategyTypes[0] = STRATEGY_USER;
+    } else if (strategyTypes.size() != nPlayers) {
+        throw std::invalid_argument("Require a strategy for each of the " +
+            std::to_string(nPlayers) + " players");
+    } else if (std::count(strategyTypes.begin(), strategyTypes.end(), STRATEGY_USER) > 1) {
+        throw std::invalid_argument("At most 1 player can be controlled by the user");
     }
     
+    checkBoard(*board);
+    
     players.reserve(nPlayers);
     
     // Seed pseudo random number generator 
@@ -33,38 +63,131 @@ Game::Game(const char *boardFile, const uint8_t _nPlayers,
     initializeState();  // initialize board/game state using prng
 }
 
+void Game::setBoard(std::shared_ptr<const Graph> _board)
+{
+    checkBoard(*_board);
+    
+    board = std::move(_board);
+    initializeState();
+}
+
+GameSnapshot Game::exportSnapshot() const
+{
+    GameSnapshot snapshot {};
+    for (uint8_t i = 0; i < nPlayers; ++i) {
+        snapshot.positions[i] = players[i].getPosition();
+        snapshot.activeTargetMasks[i] = static_cast<uint16_t>(players[i].getActiveTargetMask());
+    }
+    snapshot.boegPosition = boeg.position;
+    snapshot.diceRoll = m_diceRoll;
+    snapshot.prng = prng;
+    snapshot.boegPlayerId = boeg.playerId;
+    snapshot.moveIndex = moveIndex;
+    
+    return snapshot;
+}
+
+void Game::importSnapshot(const GameSnapshot &snapshot)
+{
+    const uint32_t nVertices = board->getNVertices();
+    const uint32_t targetBits = (1u << nTargetsPlayer) - 1;
+    // Note: Each die shows 1 to 6 eyes (see rollDice())
+    bool isValid = snapshot.boegPosition < nVertices && snapshot.boegPlayerId <= nPlayers &&
+                   snapshot.moveIndex < nPlayers &&
+                   snapshot.diceRoll >= nDice && snapshot.diceRoll <= 6u * nDice;
+    for (uint8_t i = 0; i < nPlayers; ++i) {
+        isValid = isValid && snapshot.positions[i] < nVertices &&
+                  (snapshot.activeTargetMasks[i] & ~targetBits) == 0;
+    }
+    
+    // Finished players neither hold the Boeg nor move, unless the game is
+    // over: then the player who finished last may still be current
+    // Note: The Boeg's position is not tied to any player's. Its holder
+    //       stays where they captured it while the Boeg moves on, and a
+    //       player capturing it on their last target sets it free where
+    //       others may stand
+    if (isValid) {
+        uint8_t nActive = 0;
+        bool isUserFinished = false;
+        for (uint8_t i = 0; i < nPlayers; ++i) {
+            const bool isActive = snapshot.activeTargetMasks[i] != 0;
+            nActive += isActive;
+            isUserFinished = isUserFinished || (players[i].isPlayerUser() && !isActive);
+        }
+        const bool isOver = nActive <= 1 || isUserFinished;
+        isValid = (snapshot.boegPlayerId == nPlayers ||
+                   snapshot.activeTargetMasks[snapshot.boegPlayerId] != 0) &&
+                  (isOver || snapshot.activeTargetMasks[moveOrder[snapshot.moveIndex]] != 0);
+    }
+    if (!isValid) {
+        throw std::invalid_argument("Snapshot does not fit game");
+    }
+    
+    nActivePlayers = 0;
+    for (uint8_t i = 0; i < nPlayers; ++i) {
+        Player &player = players[i];
+        player.setPosition(snapshot.positions[i]);
+        player.setActiveTargetMask(snapshot.activeTargetMasks[i]);
+        nActivePlayers += !player.isFinished();
+    }
+    boeg = {
+        .position = snapshot.boegPosition,
+        .playerId = snapshot.boegPlayerId
+    };
+    m_diceRoll = snapshot.diceRoll;
+    prng = snapshot.prng;
+    moveIndex = snapshot.moveIndex;
+}
+
+void Game::checkBoard(const Graph &candidate) const
+{
+    // Note: + 1 for random Boeg initial position
+    const uint8_t minTargets = nPlayers * nTargetsPlayer + 1;
+    if (candidate.getTargetVertices().size() < minTargets) {
+        throw std::runtime_error("Require at least " + 
+            std::to_string(minTargets) + " unique target vertices");
+    }
+    
+    if (candidate.getStationVertices().size() == 0) {
+        throw std::runtime_error("Require at least 1 non-target vertex");
+    }
+}
+
 void Game::initializeState()
 {
+    const std::vector<uint32_t> &targetVertices = board->getTargetVertices();
+    const std::vector<uint32_t> &stationVertices = board->getStationVertices();
     std::uniform_int_distribution<uint32_t> dist (
         0, static_cast<uint32_t>(stationVertices.size() - 1)
     );
     
     players.clear();
     
-    // Shuffle targets beforehand
-    std::shuffle(targetVertices.begin(), targetVertices.end(), prng);
+    // Draw distinct random targets for all players and the Boeg beforehand,
+    // i.e., the first steps of a Fisher-Yates shuffle of the board's targets.
+    // Swapped entries are tracked sparsely, as the board is shared
+    const uint32_t nTargets = static_cast<uint32_t>(targetVertices.size());
+    const uint32_t nDrawn = nPlayers * nTargetsPlayer + 1;
+    std::unordered_map<uint32_t, uint32_t> swapped;
+    const auto targetAt = [&](const uint32_t i)
+    {
+        const auto it = swapped.find(i);
+        return (it != swapped.end()) ? it->second : targetVertices[i];
+    };
+    std::vector<uint32_t> drawnTargets(nDrawn);
+    for (uint32_t i = 0; i < nDrawn; ++i) {
+        const uint32_t j = std::uniform_int_distribution<uint32_t>(i, nTargets - 1)(prng);
+        drawnTargets[i] = targetAt(j);
+        swapped[j] = targetAt(i);
+    }
+    
     for (uint8_t i = 0; i < nPlayers; ++i) {
-        const auto start = targetVertices.begin() + i * nTargetsPlayer;
+        const auto start = drawnTargets.begin() + i * nTargetsPlayer;
         const auto end   = start + nTargetsPlayer;
         
         // Generate random player position from stations
         const uint32_t randomPlayerPos = stationVertices[dist(prng)];
-        // TODO: For now user is always the first player (red).
-        //       Make user choose or assign a random player to them in the future.
-        MoveStrategy *strategy;
-        if (i == 0)
-        {
-            strategy = new UserStrategy;
-        }
-        else
-        {
-            strategy = new AvoidantStrategy;
-        }
-        
-        players.emplace_back(
-            i, randomPlayerPos, start, end, strategy,
-            initializeQuery(), initializeQuery()
-        );
+        players.emplace_back(i, randomPlayerPos, start, end, createStrategy(strategyTypes[i]));
         
         // Initialize player move order
         moveOrder[i] = i;
@@ -74,7 +197,7 @@ void Game::initializeState()
     // Randomize starting position of Boeg to a target position NOT
     // assigned to any player
     boeg = {
-        .position = targetVertices[nPlayers * nTargetsPlayer],
+        .position = drawnTargets.back(),
         .playerId = nPlayers  // invalid id
     };
     // Reset index of first to move
@@ -96,7 +219,7 @@ Game::Status Game::makeMove()
     // Fetch next player according to move order
     Player &player = getCurrentPlayer();
     assert(!player.isFinished());  // prepareNextMove() ensures the current player is active
-
+    
     // TODO: Should write makeMoveAs(player&, m_diceRoll) instead
     const std::vector<uint32_t> path = player.makeMove(*this, m_diceRoll);
     if (path.empty() && player.isPlayerUser())
@@ -106,7 +229,7 @@ Game::Status Game::makeMove()
     }
     
     validateMove(player, path, m_diceRoll);  // debug
-    printMove(path);  // debug
+    if (isMoveLogging) printMove(path);  // debug
     
     const uint32_t endPosition = path.back();
     // TODO: Should write isBoeg(player) instead of player.isBoeg(*this)
@@ -132,7 +255,7 @@ Game::Status Game::makeMove()
 }
 
 void Game::validateMove(const Player &player, const std::vector<uint32_t> &path, 
-    const uint32_t diceRoll)
+    const uint32_t diceRoll) const
 {
     if (path.empty())
     {
@@ -147,7 +270,7 @@ void Game::validateMove(const Player &player, const std::vector<uint32_t> &path,
     
     for (const uint32_t position : path)
     {
-        if (position >= getNVertices())
+        if (position >= board->getNVertices())
         {
             throw std::runtime_error("Invalid position (vertex index) encountered in path");
         }
@@ -158,14 +281,21 @@ void Game::validateMove(const Player &player, const std::vector<uint32_t> &path,
     const uint32_t startPosition = (isBoeg) ? boeg.position : player.getPosition();
     const uint32_t endPosition = path.back();
     
-    if (!isValidPath(path, startPosition, isBoeg))
+    if (!board->isValidPath(path, startPosition, isBoeg))
     {
         throw std::runtime_error("Path is not a valid simple path!");
     }
     
+    if (board->getPathWeight(path) > diceRoll)
+    {
+        throw std::runtime_error("Path is too long!");
+    }
+    
     // In case player travelled less than 'diceRoll', check if
     // this was a valid move
-    if (path.size() < maxPathLength)
+    // Note: On weighted boards, a move may also end short where no unvisited
+    //       neighbor fits the remaining steps (see Graph::isCompleteMove())
+    if (!board->isCompleteMove(path, diceRoll, isBoeg))
     {
         if (isBoeg)
         {
@@ -173,18 +303,20 @@ void Game::validateMove(const Player &player, const std::vector<uint32_t> &path,
             if (path.size() == 1)
             {
                 // Check if there are any unoccupied targets within reach
-                shortestPaths(path[0], query, isBoeg);
+                ScopedQuery query = board->acquireQuery();
+                board->shortestPaths(path[0], *query, isBoeg);
                 for (const uint32_t target : player.getActiveTargets())
                 {
-                    if (diceRoll >= query.minDistance(target) &&
+                    // Note: Distance 0 marks an unreachable target
+                    const uint32_t distance = query->minDistance(target);
+                    if (distance != 0 && diceRoll >= distance &&
                         !isOpponentAtTarget(player, target))
                     {
                         throw std::runtime_error("No player move while there is an active unoccupied target in reach!");
                     }
                 }
                 
-                const auto reachable = findAllReachableVertices(path[0], diceRoll, isBoeg);
-                for (const uint32_t position : reachable)
+                for (const uint32_t position : board->moveEndpoints(path[0], diceRoll, isBoeg))
                 {
                     if (!isOpponentAtTarget(player, position))
                     {
@@ -200,8 +332,11 @@ void Game::validateMove(const Player &player, const std::vector<uint32_t> &path,
         }
         else
         {
-            // Verify that player captured the Boeg
-            if (endPosition != boeg.position)
+            // Verify that player captured the Boeg, or stayed put for lack
+            // of valid moves (e.g., on a part of the board cut off from it)
+            Generator<uint32_t> endpoints = board->moveEndpoints(path[0], diceRoll, isBoeg);
+            if (endPosition != boeg.position &&
+                (path.size() > 1 || endpoints.begin() != endpoints.end()))
             {
                 throw std::runtime_error("Path is too short for not capturing the Boeg!");
             }
@@ -209,7 +344,7 @@ void Game::validateMove(const Player &player, const std::vector<uint32_t> &path,
     }
     else
     {
-        if (isBoeg && isOpponentAtTarget(player, endPosition))
+        if (isBoeg && path.size() > 1 && isOpponentAtTarget(player, endPosition))
         {
             throw std::runtime_error("Player tried to move on occupied position as Boeg!");
         }
@@ -355,9 +490,22 @@ std::array<uint32_t, 7> Game::prepareCharacterPositions() const
 
 bool Game::isGameOver() const
 {
-    // Either the user playing the game is the only player left,
-    // or they have finished the game before at least 1 NPC player
-    return nActivePlayers == 1 || getUserPlayer().isFinished();
+    // Either a single player is left, or the user playing the game
+    // (if any) has finished the game before at least 1 NPC player
+    if (nActivePlayers == 1)
+    {
+        return true;
+    }
+    
+    for (const auto &player : players)
+    {
+        if (player.isPlayerUser())
+        {
+            return player.isFinished();
+        }
+    }
+    
+    return false;
 }
 
 bool Game::isUserPlayingAsBoeg() const
@@ -368,12 +516,15 @@ bool Game::isUserPlayingAsBoeg() const
 void Game::rollDice()
 {
     std::uniform_int_distribution<uint32_t> dist (1, 6);
-    m_diceRoll = dist(prng);    
+    m_diceRoll = 0;
+    for (uint8_t i = 0; i < nDice; ++i) {
+        m_diceRoll += dist(prng);
+    }
 }
 
 void Game::printMove(const std::vector<uint32_t> &move) const
 {
-    const auto &vertices = getVertices();
+    const auto &vertices = board->getVertices();
     
     for (uint32_t i = 0; i + 1 < move.size(); ++i) {
         const uint32_t position = move[i];
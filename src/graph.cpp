@@ -1,249 +1,306 @@
 #include <fangpp/graph.hpp>
+#include <fangpp/mapped_file.hpp>
 
-Graph::Graph(const char *graphFile)
+#include <bit>
+#include <filesystem>
+
+Graph::Graph(const char *graphFile, const VERTEX_ORDER order /* = ORDER_FILE */) :
+    Graph(MappedFile(graphFile), graphFile, order) {}
+
+Graph::Graph(const MappedFile &file, const char *graphFile,
+    const VERTEX_ORDER order /* = ORDER_FILE */)
 {
-    // Parse XML file containing graph data
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(graphFile);
-    
-    if (!result) {
-        throw std::runtime_error("Parse error: " + std::string(result.description()));
+    const std::filesystem::path path(graphFile);
+    if (path.extension() == ".fbrd") {
+        loadBinary(file);
+    } else if (path.extension() == ".txt") {
+        loadText(file);
+    } else {
+        loadGraphML(file);
     }
+    stepParities = {computeStepParities(false), computeStepParities(true)};
+    buildBitMatrix();
     
-    // Root node of XML document
-    pugi::xml_node graphml = doc.child("graphml");
-    if (!graphml) { throw std::runtime_error("Not a valid GraphML file"); }
-    
-    // Process keys defining attributes of vertices/edges
-    typedef std::pair<std::string, std::string> nameDefaultPair;
-        
-    std::unordered_map<std::string, nameDefaultPair> vertexKeyMap;
-    std::unordered_map<std::string, nameDefaultPair> edgeKeyMap;
-    const auto keys = graphml.children("key");
-    for (const auto &key : keys) {
-        pugi::xml_attribute id = key.attribute("id");
-        if (!id) { throw std::runtime_error("Failed to fetch id of key"); }
-        pugi::xml_attribute name = key.attribute("attr.name");
-        if (!name) { throw std::runtime_error("Failed to fetch attr.name of key"); }
-        pugi::xml_attribute attrType = key.attribute("for");
-        if (!attrType) { throw std::runtime_error("Failed to fetch which primitive key is for"); }
-        
-        const std::string defaultValue = key.child_value("default");
-        
-        const std::string attrTypeStr (attrType.value());
-        if (attrTypeStr.compare("node") == 0) {
-            vertexKeyMap[id.value()] = std::make_pair(name.value(), defaultValue);
-        } else if (attrTypeStr.compare("edge") == 0) {
-            edgeKeyMap[id.value()] = std::make_pair(name.value(), defaultValue);
-        } else {
-            std::cerr << "Warning: key specified for neither node "
-                        << "nor edge. Ignoring...\n";
+    if (order != ORDER_FILE) {
+        reorderVertices(order);
+    }
+}
+
+void Graph::writeBoard(const char *boardFile) const
+{
+    const std::filesystem::path path(boardFile);
+    if (path.extension() == ".fbrd") {
+        writeBinary(boardFile);
+    } else if (path.extension() == ".txt") {
+        writeText(boardFile);
+    } else {
+        writeGraphML(boardFile);
+    }
+}
+
+Graph::Graph(const GRAPH_TYPE type, std::vector<Vertex> _vertices,
+    const std::vector<uint32_t> &edgeSources,
+    const std::vector<uint32_t> &edgeTargets,
+    const std::vector<uint8_t> &edgeBoegFlags,
+    const std::vector<uint8_t> &edgeWeights /* = {} */) :
+    nVertices(static_cast<uint32_t>(_vertices.size())),
+    vertices(std::move(_vertices)),
+    graphType(type)
+{
+    if (edgeSources.size() != edgeTargets.size() || 
+        edgeSources.size() != edgeBoegFlags.size() ||
+        (!edgeWeights.empty() && edgeSources.size() != edgeWeights.size()))
+    {
+        throw std::invalid_argument("Edge lists differ in size");
+    }
+    for (std::size_t i = 0; i < edgeSources.size(); ++i) {
+        if (edgeSources[i] >= nVertices || edgeTargets[i] >= nVertices) {
+            throw std::invalid_argument("Invalid vertex id of edge");
         }
     }
-    
-    // Note: Assumes there is only one graph. Ignores any potential graphs
-    //       defined later.
-    pugi::xml_node graph = graphml.child("graph");
-    if (!graph) {
-        throw std::runtime_error("Missing 'graph' attribute");
+    for (const uint8_t weight : edgeWeights) {
+        if (weight < 1 || weight > maxEdgeWeight) {
+            throw std::invalid_argument("Invalid edge weight");
+        }
     }
     
-    // Determine type of graph
-    pugi::xml_attribute edgeType = graph.attribute("edgedefault");
-    if (!edgeType) { throw std::runtime_error("Missing edge type (default)"); }
-    const std::string edgeTypeStr (edgeType.value());
-    if (edgeTypeStr == "undirected") {
-        graphType = GRAPH_UNDIRECTED;
-    } else if (edgeTypeStr == "directed") {
-        graphType = GRAPH_DIRECTED;
-    } else {
-        throw std::runtime_error("Unrecognized edge type. So far "
-            "only 'undirected' or 'directed' are supported");
-    }
-    
-    // Note: Typically nodes have ids 'nx' where x is the node index,
-    //       however this does not always have to be the case
-    // Process graph nodes (vertices)
-    std::unordered_map<std::string, uint32_t> vertexIndexMap;
-    
-    nVertices = 0;
-    const auto nodes = graph.children("node");
-    for (const auto &node : nodes) {
-        pugi::xml_attribute id = node.attribute("id");
-        if (!id) { throw std::runtime_error("Failed to fetch id of node"); }
-        if (vertexIndexMap.contains(id.value())) {
-            std::cerr << "Warning: Duplicate vertex id = " << id.value()
-                        << " encountered. Ignored...\n";
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        if (vertices[v].isTarget) {
+            targetVertices.push_back(v);
         } else {
-            // Insert vertex id into map
-            vertexIndexMap[id.value()] = nVertices;
-            // Process vertex attributes
-            Vertex vert{};
-            
-            // TODO: Move to function.
-            // TODO: Better method: Iterate first over entries and
-            //       set vertex properties accordingly, while removing
-            //       corresponding element in vertexKeyMap. Finally, iterate
-            //       over remaining elements in vertexKeyMap and set
-            //       associated properties to default value.
-            const auto data = node.children("data");
-            for (const auto &elem : vertexKeyMap) {
-                const std::string &key = elem.first;
-                const nameDefaultPair &nameDefault = elem.second;
-                
-                // Search <data/> nodes for matching key
-                bool isKeyFound = false;
-                for (const auto &entry : data) {
-                    pugi::xml_attribute keyAttr = entry.attribute("key");
-                    if (keyAttr && key == keyAttr.value()) {
-                        isKeyFound = true;
-                        
-                        const std::string entryStr(entry.text().get());
-                        setVertexFromEntry(vert, nameDefault.first, entryStr);
-                        break;  // move on to next elem
-                    }
-                }
-                
-                if (!isKeyFound) {
-                    // Use default value instead of (missing) entry
-                    setVertexFromEntry(vert, nameDefault.first, nameDefault.second);
-                }
-            }
-            
-            vertices.push_back(vert);
-            // Increment vertex count
-            ++nVertices;
+            stationVertices.push_back(v);
         }
     }
-    // De-allocate unnecessary capacity
-    vertices.shrink_to_fit();
-    targetVertices.shrink_to_fit();
-    stationVertices.shrink_to_fit();
-    // Initialize graph query buffers
-    query = GraphQuery(nVertices);
     
-    // Process graph edges
-    std::vector<uint32_t> counts(nVertices, 0);
-    typedef std::tuple<uint32_t,uint32_t,uint8_t> triplet;
-    std::vector<triplet> edgeList;
+    buildAdjacency(edgeSources, edgeTargets, edgeBoegFlags, edgeWeights);
+    stepParities = {computeStepParities(false), computeStepParities(true)};
+    buildBitMatrix();
+}
+
+// Build CSR arrays from list of input edges (see CSRBuilder::build())
+void Graph::buildAdjacency(const std::vector<uint32_t> &edgeSources,
+    const std::vector<uint32_t> &edgeTargets, 
+    const std::vector<uint8_t> &edgeBoegFlags,
+    const std::vector<uint8_t> &edgeWeights)
+{
+    setAdjacency(CSRBuilder().build(nVertices, graphType == GRAPH_UNDIRECTED,
+        edgeSources, edgeTargets, edgeBoegFlags, edgeWeights));
+}
+
+void Graph::setAdjacency(CSRAdjacency &&adjacency)
+{
+    offsets = std::move(adjacency.offsets);
+    regularEnds = std::move(adjacency.regularEnds);
+    nbors = std::move(adjacency.nbors);
+    weights = std::move(adjacency.weights);
+    maxWeight = adjacency.maxWeight;
+    nborEnds.assign(offsets.begin() + 1, offsets.end());
+    nEdges = offsets[nVertices];
+}
+
+// Two-colors the vertices of each component, flipping the color along edges
+// of odd weight (union-find keeping the parity of each vertex relative to
+// its parent). An edge within a component closes a cycle, whose length is
+// odd if the edge contradicts the colors of its ends. Edge directions are
+// ignored: a directed path is a path of the underlying undirected board
+std::vector<uint8_t> Graph::computeStepParities(const bool isBoeg) const
+{
+    std::vector<uint32_t> parents(nVertices);
+    std::iota(parents.begin(), parents.end(), 0);
+    std::vector<uint8_t> parities(nVertices, 0);    // parity relative to parent
+    std::vector<uint8_t> isOddCycle(nVertices, 0);  // of component (at root)
     
-    {
-        nEdges = 0;
-        const auto edges = graph.children("edge");
-        for (const auto &edge : edges) {
-            pugi::xml_attribute source = edge.attribute("source");
-            if (!source) { throw std::runtime_error("Missing source vertex for edge"); }
-            pugi::xml_attribute target = edge.attribute("target");
-            if (!target) { throw std::runtime_error("Missing target vertex for edge"); }
-                
-            const auto sourceIt = vertexIndexMap.find(source.value());
-            if (sourceIt == vertexIndexMap.end()) { throw std::runtime_error("Invalid source vertex id for edge"); }
-            const auto targetIt = vertexIndexMap.find(target.value());
-            if (sourceIt == vertexIndexMap.end()) { throw std::runtime_error("Invalid target vertex id for edge"); }
-            
-            const uint32_t sourceIndex = sourceIt->second;
-            const uint32_t targetIndex = targetIt->second;
-            
-            uint8_t isBoegOnly = 0;
-            const auto data = edge.children("data");
-            for (const auto &elem : edgeKeyMap) {
-                const std::string &key = elem.first;
-                const nameDefaultPair &nameDefault = elem.second;
-                
-                bool isKeyFound = false;
-                for (const auto &entry : data) {
-                    pugi::xml_attribute keyAttr = entry.attribute("key");
-                    if (keyAttr && key == keyAttr.value()) {
-                        const std::string entryStr (entry.text().get());
-                        
-                        if (nameDefault.first == "boegEdge" && entryStr == "true") {
-                            isKeyFound = true;
-                            isBoegOnly = 1;
-                            break;
-                        }
-                    }
-                }
-                
-                if (!isKeyFound) {
-                    // Use default value instead of (missing) entry
-                    if (nameDefault.second == "true") isBoegOnly = 1;
-                }
-            }
-            
-            // Count outdegree of source vertex
-            counts[sourceIndex] += 1;
-            // Put edge in edgeList for later use
-            edgeList.emplace_back(sourceIndex, targetIndex, isBoegOnly);
-            
-            if (graphType == GRAPH_UNDIRECTED) {
-                // Also add edge going in opposite direction
-                counts[targetIndex] += 1;
-                edgeList.emplace_back(targetIndex, sourceIndex, isBoegOnly);
+    // Root of v and parity of v relative to it (compresses the path to root)
+    const auto findRoot = [&parents, &parities](const uint32_t v) {
+        uint32_t root = v;
+        uint8_t parity = 0;
+        while (parents[root] != root) {
+            parity ^= parities[root];
+            root = parents[root];
+        }
+        uint8_t uParity = parity;
+        for (uint32_t u = v; u != root; ) {
+            const uint32_t parent = parents[u];
+            const uint8_t parentParity = uParity ^ parities[u];
+            parents[u] = root;
+            parities[u] = uParity;
+            u = parent;
+            uParity = parentParity;
+        }
+        return std::make_pair(root, parity);
+    };
+    
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        for (uint32_t i = start; i < end; ++i) {
+            const auto [vRoot, vParity] = findRoot(v);
+            const auto [nRoot, nParity] = findRoot(nbors[i]);
+            const uint8_t edgeParity = edgeWeight(i) & 1;
+            if (vRoot == nRoot) {
+                if ((vParity ^ nParity) != edgeParity) isOddCycle[vRoot] = 1;
+            } else {
+                parents[nRoot] = vRoot;
+                parities[nRoot] = vParity ^ nParity ^ edgeParity;
+                isOddCycle[vRoot] |= isOddCycle[nRoot];
             }
         }
     }
     
-    offsets.resize(nVertices + 1);
-    offsets[0] = 0;  // starting offset
-    
-    std::inclusive_scan(counts.begin(), counts.end(), offsets.begin() + 1);
-    // Reset counts for placement of target vertices in bucket associated
-    // with source vertex
-    std::fill(counts.begin(), counts.end(), 0);
+    std::vector<uint8_t> classes(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const auto [root, parity] = findRoot(v);
+        classes[v] = (isOddCycle[root]) ? noParity : parity;
+    }
     
-    // Fill edge array
-    nEdges = static_cast<uint32_t>(edgeList.size());
-    edges.resize(nEdges);
-    for (const auto &edge : edgeList) {
-        uint32_t sourceIndex, targetIndex;
-        uint8_t isBoegOnly;
-        std::tie(sourceIndex, targetIndex, isBoegOnly) = edge;
-        // Store index of target vertex in bucket of source vertex
-        const uint32_t edgeIndex = offsets[sourceIndex] + (counts[sourceIndex]++);
-        edges[edgeIndex] = Edge(targetIndex, isBoegOnly);
+    return classes;
+}
+
+// Note: Each thread keeps its own free list of query buffers. Buffers are
+//       never shared between graphs concurrently, only reused sequentially
+static thread_local std::vector<std::unique_ptr<GraphQuery>> queryPool;
+
+ScopedQuery::ScopedQuery(const uint32_t nVertices)
+{
+    if (queryPool.empty()) {
+        query = std::make_unique<GraphQuery>(nVertices);
+    } else {
+        query = std::move(queryPool.back());
+        queryPool.pop_back();
+        query->reserve(nVertices);
     }
 }
 
-void Graph::setVertexFromEntry(Vertex &vert, const std::string &name, 
-    const std::string &value)
+ScopedQuery::~ScopedQuery()
 {
-    if (name == "location") 
-    {
-        vert.location = value;
-    } 
-    else if (name == "xpos")
-    {
-        vert.xpos = std::stof(value);
+    if (query) {
+        queryPool.push_back(std::move(query));
     }
-    else if (name == "ypos")
-    {
-        vert.ypos = std::stof(value);
+}
+
+bool Graph::precomputeDistanceTables()
+{
+    if (nVertices > DistanceTable::maxVertices) {
+        return false;  // quadratic memory is not worth it
     }
-    else if (name == "targetLocation")
-    {
-        vert.isTarget = value == "true";
+    
+    distanceTables[0] = computeDistanceTable(false);
+    distanceTables[1] = computeDistanceTable(true);
+    
+    return true;
+}
+
+// Runs a BFS from every vertex and records distances, as well as the first
+// hop on the BFS tree path from source to each vertex
+DistanceTable Graph::computeDistanceTable(const bool isBoeg) const
+{
+    DistanceTable table(nVertices);
+    ScopedQuery spQuery = acquireQuery();
+    
+    for (uint32_t source = 0; source < nVertices; ++source) {
+        uint16_t *distances = &table.distances[table.index(source, 0)];
+        uint16_t *nextHops  = &table.nextHops[table.index(source, 0)];
         
-        if (vert.isTarget)
-        {
-            // Add vertex index to set of target vertices
-            targetVertices.push_back(nVertices);
-        } 
-        else
-        {
-            // Add vertex to set of (non-target) station vertices
-            stationVertices.push_back(nVertices);
+        spQuery->reset();
+        const uint32_t nVisited = (isWeighted()) ? dialSearch(source, *spQuery, isBoeg)
+                                                 : breadthFirstSearch(source, *spQuery, isBoeg);
+        
+        nextHops[source] = source;
+        // Note: Search list holds visited vertices in order of increasing
+        //       distance, i.e., parents are always processed before children
+        for (uint32_t i = 1; i < nVisited; ++i) {
+            const uint32_t v = spQuery->searchList[i];
+            const QueryRecord &record = spQuery->records[v];
+            
+            distances[v] = record.distance;
+            // Neighbors of source are their own first hop, all other
+            // vertices inherit the first hop of their BFS parent
+            nextHops[v] = (record.child == source) ? v : nextHops[record.child];
         }
-    } 
-    else
-    {
-        throw std::runtime_error("Unrecognized attribute name: " + name);
     }
+    
+    return table;
 }
 
-// TODO: Decide if this amount of abstraction is really necessary...
-GraphQuery Graph::initializeQuery() const
+// Note: Witnesses are stored with one vertex per dice step, so weighted
+//       boards are not indexed
+bool Graph::precomputeReachabilityIndex()
 {
-    return GraphQuery(nVertices);
+    if (nVertices > ReachabilityIndex::maxVertices || isWeighted()) {
+        return false;
+    }
+    
+    reachabilityIndexes[0] = computeReachabilityIndex(false);
+    reachabilityIndexes[1] = computeReachabilityIndex(true);
+    if (reachabilityIndexes[0].isEmpty() || reachabilityIndexes[1].isEmpty()) {
+        reachabilityIndexes = {};
+        return false;
+    }
+    
+    return true;
+}
+
+// Enumerates all simple paths of up to maxPathLength edges from every vertex
+// Note: Paths are enumerated in neighbor order, so the witness of a target
+//       is the first path to it in that order
+ReachabilityIndex Graph::computeReachabilityIndex(const bool isBoeg) const
+{
+    ReachabilityIndex index(nVertices);
+    
+    std::array<uint32_t, ReachabilityIndex::maxPathLength + 1> path;
+    std::vector<uint8_t> visited(nVertices, 0);
+    uint64_t nVisitsLeft = ReachabilityIndex::maxPathVisits;
+    for (uint32_t source = 0; source < nVertices; ++source) {
+        path[0] = source;
+        if (!indexSimplePathsRecursive(source, 0, path, visited, index, nVisitsLeft, isBoeg)) {
+            return ReachabilityIndex();
+        }
+    }
+    
+    return index;
+}
+
+bool Graph::indexSimplePathsRecursive(const uint32_t v, const uint32_t depth,
+    std::array<uint32_t, ReachabilityIndex::maxPathLength + 1> &path,
+    std::vector<uint8_t> &visited, ReachabilityIndex &index, 
+    uint64_t &nVisitsLeft, const bool isBoeg) const
+{
+    if (nVisitsLeft == 0) {
+        return false;  // give up
+    }
+    --nVisitsLeft;
+    path[depth] = v;
+    
+    if (depth > 0) {
+        const uint32_t source = path[0];
+        uint64_t &word = index.reachable[index.setIndex(source, depth) + v / 64];
+        const uint64_t mask = uint64_t(1) << (v % 64);
+        if (!(word & mask)) {
+            // First simple path of this length to v: record it as witness
+            word |= mask;
+            std::copy(path.begin(), path.begin() + depth + 1,
+                &index.witnesses[index.witnessIndex(source, v, depth)]);
+        }
+    }
+    
+    if (depth == ReachabilityIndex::maxPathLength) {
+        return true;  // backtrack
+    }
+    
+    // Visit this vertex
+    visited[v] = 1;
+    bool isComplete = true;
+    const auto [start, end] = vertexBounds(v, isBoeg);
+    for (uint32_t i = start; i < end && isComplete; ++i) {
+        const uint32_t n = nbors[i];
+        if (!visited[n]) {
+            isComplete = indexSimplePathsRecursive(n, depth + 1, path, visited, index,
+                nVisitsLeft, isBoeg);
+        }
+    }
+    // Backtrack
+    visited[v] = 0;
+    
+    return isComplete;
 }
 
 // Visits all vertices starting from source using shortest paths
@@ -257,43 +314,417 @@ void Graph::shortestPaths(const uint32_t source, GraphQuery &spQuery,
     
     // Reset query structure
     spQuery.reset();
-        
+    
+    if (hasDistanceTables()) {
+        // Simply answer all subsequent queries from precomputed table
+        spQuery.bindTable(&distanceTables[isBoeg], source);
+        return;
+    }
+    if (hasDistanceOracle()) {
+        // Answer distances from labels, follow paths neighbor by neighbor
+        spQuery.bindOracle(&distanceOracles[isBoeg], this, source, isBoeg);
+        return;
+    }
+    
+    if (isWeighted()) {
+        dialSearch(source, spQuery, isBoeg);
+    } else {
+        breadthFirstSearch(source, spQuery, isBoeg);
+    }
+}
+
+// Level-synchronous BFS on a freshly reset query. The search list doubles as
+// FIFO and as record of the visiting order: each level occupies a contiguous
+// range of it. On large undirected boards, levels with a large frontier are
+// expanded bottom-up (unvisited vertices look for a parent in the frontier),
+// which avoids checking the many edges leading to already visited vertices.
+// Returns the number of visited vertices
+uint32_t Graph::breadthFirstSearch(const uint32_t source, GraphQuery &spQuery,
+    const bool isBoeg) const
+{
+    assert(spQuery.records.size() >= nVertices && "query does not match graph");
+    
+    if (bitMatrix) {
+        return bitMatrix->breadthFirstSearch(source, spQuery, isBoeg);
+    }
+    
+    // Note: Bottom-up steps rely on incoming edges being equal to outgoing ones
+    const bool isBottomUpEnabled = graphType == GRAPH_UNDIRECTED &&
+                                   nVertices >= bottomUpMinVertices;
+    bool isBottomUp = false;
+    // Number of edges leaving not yet expanded vertices (upper bound)
+    uint64_t unexploredEdges = nEdges;
+    
     // Add source to current search list --> FIFO
-    std::list<uint32_t> searchList(1, source);
-    spQuery.visited[source] = 1;  // source has been visited already
+    spQuery.searchList[0] = source;
+    // Source has been visited already
+    spQuery.records[source] = {0, source, spQuery.generation};
     
-    while (!searchList.empty()) {
-        const uint32_t v = searchList.front();
-        searchList.pop_front();
+    uint32_t head = 0, tail = 1;
+    for (uint32_t level = 0; head < tail; ++level) {
+        const uint32_t levelEnd = tail;
+        
+        if (isBottomUpEnabled) {
+            uint64_t frontierEdges = 0;
+            for (uint32_t i = head; i < levelEnd; ++i) {
+                const auto [start, end] = vertexBounds(spQuery.searchList[i], isBoeg);
+                frontierEdges += end - start;
+            }
+            
+            const uint32_t frontierSize = levelEnd - head;
+            if (!isBottomUp && frontierEdges > unexploredEdges / bottomUpAlpha) {
+                isBottomUp = true;
+            } else if (isBottomUp && frontierSize < nVertices / bottomUpBeta) {
+                isBottomUp = false;
+            }
+            unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+        }
+        
+        tail = (isBottomUp) ? bottomUpStep(level, tail, spQuery, isBoeg)
+                            : topDownStep(head, levelEnd, tail, spQuery, isBoeg);
+        head = levelEnd;
+    }
+    
+    return tail;
+}
+
+// Dijkstra's algorithm with Dial's bucket queue: as edge weights are at most
+// maxWeight, all tentative distances lie within maxWeight of the current
+// one, so maxWeight + 1 buckets indexed by distance modulo their number
+// suffice. Vertices are re-inserted when their distance drops; outdated
+// entries are skipped. The search list records vertices in the order they
+// are settled, i.e., by increasing distance (as for breadthFirstSearch()).
+// Returns the number of visited vertices
+uint32_t Graph::dialSearch(const uint32_t source, GraphQuery &spQuery,
+    const bool isBoeg) const
+{
+    assert(spQuery.records.size() >= nVertices && "query does not match graph");
+    
+    QueryRecord *records = spQuery.records.data();
+    uint32_t *searchList = spQuery.searchList.data();
+    const uint32_t generation = spQuery.generation;
+    
+    const uint32_t nBuckets = maxWeight + 1;
+    if (spQuery.buckets.size() < nBuckets) {
+        spQuery.buckets.resize(nBuckets);
+    }
+    
+    records[source] = {0, source, generation};
+    spQuery.buckets[0].push_back(source);
+    uint32_t nQueued = 1, tail = 0;
+    for (uint32_t distance = 0; nQueued > 0; ++distance) {
+        // Note: Weights are in [1, maxWeight], so relaxations never insert
+        //       into the bucket being scanned
+        std::vector<uint32_t> &bucket = spQuery.buckets[distance % nBuckets];
+        for (const uint32_t v : bucket) {
+            --nQueued;
+            if (records[v].distance != distance) continue;  // outdated entry
+            
+            searchList[tail++] = v;
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                const uint32_t n = nbors[i];
+                const uint32_t nDistance = distance + weights[i];
+                if (records[n].stamp != generation || nDistance < records[n].distance) {
+                    records[n] = {nDistance, v, generation};
+                    spQuery.buckets[nDistance % nBuckets].push_back(n);
+                    ++nQueued;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    
+    return tail;
+}
+
+// Same as dialSearch(), but vertices farther than 'maxDistance' from source
+// are neither visited nor queued, so the search only touches the region a
+// dice roll can reach. Works on unweighted boards, too (as a BFS). Once
+// 'maxVisited' vertices have been visited, the search stops and lowers
+// 'maxDistance' to the distance up to which it visited all vertices. Queued
+// vertices then get distance maxDistance + 1, a lower bound (as for all
+// vertices not reached)
+uint32_t Graph::boundedSearch(const uint32_t source, uint32_t &maxDistance,
+    const uint32_t maxVisited, GraphQuery &spQuery, const bool isBoeg) const
+{
+    assert(spQuery.records.size() >= nVertices && "query does not match graph");
+    
+    QueryRecord *records = spQuery.records.data();
+    uint32_t *searchList = spQuery.searchList.data();
+    const uint32_t generation = spQuery.generation;
+    
+    const uint32_t nBuckets = maxWeight + 1;
+    if (spQuery.buckets.size() < nBuckets) {
+        spQuery.buckets.resize(nBuckets);
+    }
+    
+    records[source] = {0, source, generation};
+    spQuery.buckets[0].push_back(source);
+    uint32_t nQueued = 1, tail = 0;
+    for (uint32_t distance = 0; nQueued > 0; ++distance) {
+        std::vector<uint32_t> &bucket = spQuery.buckets[distance % nBuckets];
+        for (const uint32_t v : bucket) {
+            --nQueued;
+            if (records[v].distance != distance) continue;  // outdated entry
+            
+            if (tail >= maxVisited) {
+                // Note: Vertices yet to visit are at least 'distance' away.
+                //       Outdated entries refer to visited vertices
+                maxDistance = distance - 1;
+                for (std::vector<uint32_t> &queued : spQuery.buckets) {
+                    for (const uint32_t u : queued) {
+                        records[u].distance = std::min(records[u].distance, distance);
+                    }
+                    queued.clear();
+                }
+                return tail;
+            }
+            
+            searchList[tail++] = v;
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                const uint32_t n = nbors[i];
+                const uint32_t nDistance = distance + edgeWeight(i);
+                if (nDistance > maxDistance) continue;
+                if (records[n].stamp != generation || nDistance < records[n].distance) {
+                    records[n] = {nDistance, v, generation};
+                    spQuery.buckets[nDistance % nBuckets].push_back(n);
+                    ++nQueued;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    
+    return tail;
+}
+
+// Expands all vertices of the current level [head, levelEnd) in the search
+// list and returns the new end of the search list
+uint32_t Graph::topDownStep(const uint32_t head, const uint32_t levelEnd, 
+    uint32_t tail, GraphQuery &spQuery, const bool isBoeg) const
+{
+    QueryRecord *records = spQuery.records.data();
+    uint32_t *searchList = spQuery.searchList.data();
+    const uint32_t generation = spQuery.generation;
+    
+    for (uint32_t j = head; j < levelEnd; ++j) {
+        const uint32_t v = searchList[j];
+        const uint32_t distance = records[v].distance + 1;
         
         // Iterate over all adjacent vertices
-        const auto [start, end] = vertexBounds(v);
+        const auto [start, end] = vertexBounds(v, isBoeg);
         for (uint32_t i = start; i < end; ++i) {
-            const Edge edge = edges[i];
-            const uint32_t n = edge.nborId;
-            // Check if this edge is accessible 
-            const bool isEdgeAccessible = isBoeg || !edge.isBoegOnly;
+            const uint32_t n = nbors[i];
             // Make sure that neighbor has not been visited yet
-            if (isEdgeAccessible && !spQuery.visited[n]) {
-                // Visit neighboring vertex
-                spQuery.visited[n] = 1;
-                // Update distance and child vertex for v
-                spQuery.distances[n] = spQuery.distances[v] + 1;
+            if (records[n].stamp != generation) {
+                // Visit neighboring vertex, update distance and child vertex
                 // Note: Have to store children in REVERSE order,
                 //       otherwise last write wins
-                spQuery.children[n] = v;
+                records[n] = {distance, v, generation};
                 // Add neighbor to search list
-                searchList.push_back(n);
+                searchList[tail++] = n;
+            }
+        }
+    }
+    
+    return tail;
+}
+
+// Lets every unvisited vertex search for a neighbor on the current level
+// and returns the new end of the search list
+uint32_t Graph::bottomUpStep(const uint32_t level, uint32_t tail, 
+    GraphQuery &spQuery, const bool isBoeg) const
+{
+    QueryRecord *records = spQuery.records.data();
+    uint32_t *searchList = spQuery.searchList.data();
+    const uint32_t generation = spQuery.generation;
+    
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        if (records[v].stamp == generation) continue;
+        
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        for (uint32_t i = start; i < end; ++i) {
+            const uint32_t n = nbors[i];
+            // Note: Vertices visited during this step have distance level + 1
+            if (records[n].stamp == generation && records[n].distance == level) {
+                records[v] = {level + 1, n, generation};
+                searchList[tail++] = v;
+                break;  // found a parent
+            }
+        }
+    }
+    
+    return tail;
+}
+
+// Buffers of multi-source BFS, kept per thread like query buffers
+// Note: All entries are zero between searches
+struct MultiSourceBuffers {
+    std::vector<uint64_t> seen;      // bit i set: vertex reached from source i
+    std::vector<uint64_t> frontier;  // bits of sources reaching vertex on current level
+    std::vector<uint64_t> next;      // bits of sources reaching vertex on next level
+    std::vector<uint32_t> frontierList, nextList, visitedList;
+    std::vector<uint32_t> destinationHeads;  // first destination slot + 1 of each vertex
+    std::vector<uint32_t> destinationLinks;  // next slot + 1 with same vertex
+};
+
+static thread_local MultiSourceBuffers multiSourceBuffers;
+
+std::vector<uint32_t> Graph::multiSourceDistances(std::span<const uint32_t> sources,
+    std::span<const uint32_t> destinations, const bool isBoeg /* = false */) const
+{
+    for (const uint32_t v : sources) {
+        if (v >= nVertices) throw std::invalid_argument("Invalid source vertex");
+    }
+    for (const uint32_t v : destinations) {
+        if (v >= nVertices) throw std::invalid_argument("Invalid destination vertex");
+    }
+    
+    const uint32_t nDestinations = static_cast<uint32_t>(destinations.size());
+    std::vector<uint32_t> distances(sources.size() * nDestinations, 0);
+    
+    if (hasDistanceTables()) {
+        const DistanceTable &table = distanceTables[isBoeg];
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            for (uint32_t j = 0; j < nDestinations; ++j) {
+                distances[i * nDestinations + j] = table.minDistance(sources[i], destinations[j]);
+            }
+        }
+        
+        return distances;
+    }
+    if (hasDistanceOracle()) {
+        const DistanceOracle &oracle = distanceOracles[isBoeg];
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            for (uint32_t j = 0; j < nDestinations; ++j) {
+                distances[i * nDestinations + j] = oracle.minDistance(sources[i], destinations[j]);
+            }
+        }
+        
+        return distances;
+    }
+    
+    if (isWeighted()) {
+        // Bit-parallel levels only exist for unit weights
+        ScopedQuery query = acquireQuery();
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            query->reset();
+            dialSearch(sources[i], *query, isBoeg);
+            for (uint32_t j = 0; j < nDestinations; ++j) {
+                distances[i * nDestinations + j] = query->minDistance(destinations[j]);
+            }
+        }
+        
+        return distances;
+    }
+    
+    MultiSourceBuffers &buffers = multiSourceBuffers;
+    if (buffers.seen.size() < nVertices) {
+        buffers.seen.resize(nVertices, 0);
+        buffers.frontier.resize(nVertices, 0);
+        buffers.next.resize(nVertices, 0);
+        buffers.destinationHeads.resize(nVertices, 0);
+    }
+    // Chain destination slots of each vertex (destinations may repeat)
+    buffers.destinationLinks.resize(nDestinations);
+    for (uint32_t j = nDestinations; j-- > 0; ) {
+        buffers.destinationLinks[j] = buffers.destinationHeads[destinations[j]];
+        buffers.destinationHeads[destinations[j]] = j + 1;
+    }
+    
+    for (std::size_t batchStart = 0; batchStart < sources.size(); batchStart += multiSourceBatchSize) {
+        const std::size_t batchSize = std::min<std::size_t>(multiSourceBatchSize, sources.size() - batchStart);
+        multiSourceBatch(sources.subspan(batchStart, batchSize), nDestinations,
+            &distances[batchStart * nDestinations], isBoeg);
+    }
+    
+    for (const uint32_t v : destinations) {
+        buffers.destinationHeads[v] = 0;
+    }
+    
+    return distances;
+}
+
+// MS-BFS (Then et al., 2014): one BFS whose per-vertex state holds one bit
+// per source, so all sources share a single traversal of every edge on each
+// level. Fills rows of 'distances' for the given sources
+void Graph::multiSourceBatch(std::span<const uint32_t> sources,
+    const uint32_t nDestinations, uint32_t *distances, const bool isBoeg) const
+{
+    assert(sources.size() <= multiSourceBatchSize);
+    
+    MultiSourceBuffers &buffers = multiSourceBuffers;
+    uint64_t *seen = buffers.seen.data();
+    uint64_t *frontier = buffers.frontier.data();
+    uint64_t *next = buffers.next.data();
+    
+    for (uint32_t i = 0; i < sources.size(); ++i) {
+        const uint32_t source = sources[i];
+        if (seen[source] == 0) {
+            buffers.visitedList.push_back(source);
+            buffers.frontierList.push_back(source);
+        }
+        seen[source] |= uint64_t(1) << i;
+        frontier[source] |= uint64_t(1) << i;
+    }
+    
+    for (uint32_t level = 1; !buffers.frontierList.empty(); ++level) {
+        // Push source bits of frontier to neighbors
+        for (const uint32_t v : buffers.frontierList) {
+            const uint64_t bits = frontier[v];
+            frontier[v] = 0;
+            
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                const uint32_t n = nbors[i];
+                const uint64_t fresh = bits & ~seen[n];
+                if (fresh != 0) {
+                    if (next[n] == 0) buffers.nextList.push_back(n);
+                    next[n] |= fresh;
+                }
+            }
+        }
+        buffers.frontierList.clear();
+        
+        // Vertices reached for the first time by some sources form the next
+        // frontier (for exactly those sources)
+        for (const uint32_t v : buffers.nextList) {
+            const uint64_t bits = next[v];
+            next[v] = 0;
+            
+            if (seen[v] == 0) buffers.visitedList.push_back(v);
+            seen[v] |= bits;
+            frontier[v] = bits;
+            buffers.frontierList.push_back(v);
+            
+            for (uint32_t slot = buffers.destinationHeads[v]; slot != 0; slot = buffers.destinationLinks[slot - 1]) {
+                for (uint64_t word = bits; word != 0; word &= word - 1) {
+                    distances[std::countr_zero(word) * nDestinations + slot - 1] = level;
+                }
             }
         }
+        buffers.nextList.clear();
     }
+    
+    for (const uint32_t v : buffers.visitedList) {
+        seen[v] = 0;
+    }
+    buffers.visitedList.clear();
 }
 
 bool Graph::findPathOfLengthRecursive(const uint32_t v, 
     const uint32_t target, const uint32_t pathLength, 
-    const bool isBoeg /* = false */)
+    const bool isBoeg, GraphQuery &query, const GraphQuery &bounds,
+    const uint32_t outerBound, uint32_t &visitBudget) const
 {
-    const uint32_t distance = query.distances[v];
+    if (visitBudget == 0) {
+        return false;  // give up (callers unwind without trying further neighbors)
+    }
+    --visitBudget;
+    
+    const uint32_t distance = query.records[v].distance;
     if (distance == pathLength && v == target) {
         return true;  // path of required length to target found
     } else if ((distance == pathLength && v != target) ||
@@ -304,80 +735,482 @@ bool Graph::findPathOfLengthRecursive(const uint32_t v,
     }
     
     // Visit this vertex
-    query.visited[v] = 1;
-    // Check all neighboring vertices
-    const auto [start, end] = vertexBounds(v);
+    query.visit(v);
+    // Collect neighbors that can still reach target in the remaining steps.
+    // Neighbors whose shortest path to target takes all of them come first:
+    // following that path succeeds unless it runs into the path so far,
+    // while shorter ones must be padded by detours
+    std::vector<uint32_t> &candidates = query.candidates;
+    const std::size_t first = candidates.size();
+    const auto [start, end] = vertexBounds(v, isBoeg);
     for (uint32_t i = start; i < end; ++i) {
-        const Edge edge = edges[i];
-        const uint32_t n = edge.nborId;  // neighbor
+        const uint32_t n = nbors[i];  // neighbor
+        const uint32_t nDistance = distance + edgeWeight(i);
+        if (!query.isVisited(n) && nDistance <= pathLength &&
+            targetBound(bounds, n, outerBound) <= pathLength - nDistance)
+        {
+            candidates.push_back(i);
+        }
+    }
+    const std::size_t last = candidates.size();
+    // Note: Ties keep neighbor order
+    std::sort(candidates.begin() + first, candidates.end(),
+        [this, &bounds, outerBound](const uint32_t a, const uint32_t b) {
+            const uint32_t aSteps = targetBound(bounds, nbors[a], outerBound) + edgeWeight(a);
+            const uint32_t bSteps = targetBound(bounds, nbors[b], outerBound) + edgeWeight(b);
+            return aSteps > bSteps || (aSteps == bSteps && a < b);
+        });
+    
+    for (std::size_t k = first; k < last; ++k) {
+        // Note: Deeper levels push their candidates after 'last' and pop
+        //       them before returning (unless a path is found)
+        const uint32_t i = candidates[k];
+        const uint32_t n = nbors[i];
+        // Update
+        query.records[n].distance = distance + edgeWeight(i);
+        query.records[v].child = n;
         
-        const bool isEdgeAccessible = isBoeg || !edge.isBoegOnly;
-        if (isEdgeAccessible && !query.visited[n]) {
-            // Update
-            query.distances[n] = distance + 1;
-            query.children[v] = n;
-            
-            // Recursively move to neighbor vertex n
-            if (findPathOfLengthRecursive(n, target, pathLength, isBoeg)) {
-                return true;  // path has been found --> done
-            }
+        // Recursively move to neighbor vertex n
+        if (findPathOfLengthRecursive(n, target, pathLength, isBoeg, query, bounds,
+                outerBound, visitBudget))
+        {
+            return true;  // path has been found --> done
         }
+        if (visitBudget == 0) break;
     }
+    candidates.resize(first);
     
     // Backtrack
-    query.visited[v] = 0;
+    query.unvisit(v);
     
     return false;
 }
 
-void Graph::findAllReachableVerticesRecursive(const uint32_t v, 
-    const uint32_t pathLength, const bool isBoeg /* = false */,
-    std::unordered_set<uint32_t> &reachable)
+// Reverse adjacency of the region around source on directed boards
+struct TargetBoundBuffers {
+    std::vector<uint32_t> offsets;    // start of incoming edges of each local vertex
+    std::vector<uint32_t> sources;    // local id of source of each incoming edge
+    std::vector<uint8_t> weights;     // weight of each incoming edge
+    std::vector<uint32_t> distances;  // steps from each local vertex to target
+};
+
+static thread_local TargetBoundBuffers targetBoundBuffers;
+
+// Lower bounds of the remaining steps for findPathOfLengthRecursive(): steps
+// from vertices near target to target. Undirected boards search from target
+// until 'pathLength' steps or until the search grows too large for a single
+// query (on boards where few steps reach many vertices). Directed boards
+// search back from target through the region within 'pathLength' steps of
+// source (counting steps along paths inside it, which a path of length
+// 'pathLength' never leaves), if that region is small enough. Returns the
+// bound of vertices the search does not reach (0 if there is no search,
+// infinity for all vertices if target lies outside the region)
+uint32_t Graph::computeTargetBounds(const uint32_t source, const uint32_t target,
+    const uint32_t pathLength, const bool isBoeg, GraphQuery &bounds) const
 {
-    const uint32_t distance = query.distances[v];
-    if (distance == pathLength) {
-        // Found new reachable position
-        // Note: No effect if vertex is already contained
-        reachable.insert(v);
-        return;  // backtrack
+    uint32_t maxDistance = pathLength;
+    if (graphType == GRAPH_UNDIRECTED) {
+        boundedSearch(target, maxDistance, maxTargetBoundVertices, bounds, isBoeg);
+        
+        return maxDistance + 1;
     }
-    // Note: At this point distance < pathLength
     
-    // Visit this vertex
-    query.visited[v] = 1;
-    // Check all neighboring vertices
-    const auto [start, end] = vertexBounds(v);
+    const uint32_t nLocal = boundedSearch(source, maxDistance, maxTargetBoundVertices, bounds, isBoeg);
+    if (maxDistance < pathLength) {
+        bounds.reset();  // region too large
+        return 0;
+    }
+    const uint32_t infinity = std::numeric_limits<uint32_t>::max();
+    if (!bounds.isVisited(target)) {
+        // Note: Marks of the search from source are no bounds; without them
+        //       the bound of source is infinite, so callers stop right away
+        bounds.reset();
+        return infinity;
+    }
+    
+    // Number vertices of the region in search order (child fields are free)
+    QueryRecord *records = bounds.records.data();
+    for (uint32_t k = 0; k < nLocal; ++k) {
+        records[bounds.searchList[k]].child = k;
+    }
+    
+    TargetBoundBuffers &buffers = targetBoundBuffers;
+    buffers.offsets.assign(nLocal + 1, 0);
+    for (uint32_t k = 0; k < nLocal; ++k) {
+        const auto [start, end] = vertexBounds(bounds.searchList[k], isBoeg);
+        for (uint32_t i = start; i < end; ++i) {
+            if (bounds.isVisited(nbors[i])) ++buffers.offsets[records[nbors[i]].child + 1];
+        }
+    }
+    std::inclusive_scan(buffers.offsets.begin(), buffers.offsets.end(), buffers.offsets.begin());
+    buffers.sources.resize(buffers.offsets[nLocal]);
+    buffers.weights.resize(buffers.offsets[nLocal]);
+    for (uint32_t k = 0; k < nLocal; ++k) {
+        const auto [start, end] = vertexBounds(bounds.searchList[k], isBoeg);
+        for (uint32_t i = start; i < end; ++i) {
+            if (!bounds.isVisited(nbors[i])) continue;
+            // Note: Offsets serve as fill positions; shifting them by one
+            //       afterwards restores them
+            const uint32_t slot = buffers.offsets[records[nbors[i]].child]++;
+            buffers.sources[slot] = k;
+            buffers.weights[slot] = static_cast<uint8_t>(edgeWeight(i));
+        }
+    }
+    std::shift_right(buffers.offsets.begin(), buffers.offsets.end(), 1);
+    buffers.offsets[0] = 0;
+    
+    // Dial search along incoming edges, from target
+    buffers.distances.assign(nLocal, infinity);
+    const uint32_t nBuckets = maxWeight + 1;
+    const uint32_t localTarget = records[target].child;
+    buffers.distances[localTarget] = 0;
+    bounds.buckets[0].push_back(localTarget);
+    uint32_t nQueued = 1;
+    for (uint32_t distance = 0; nQueued > 0; ++distance) {
+        std::vector<uint32_t> &bucket = bounds.buckets[distance % nBuckets];
+        for (const uint32_t k : bucket) {
+            --nQueued;
+            if (buffers.distances[k] != distance) continue;  // outdated entry
+            
+            for (uint32_t j = buffers.offsets[k]; j < buffers.offsets[k + 1]; ++j) {
+                const uint32_t u = buffers.sources[j];
+                const uint32_t uDistance = distance + buffers.weights[j];
+                if (uDistance <= pathLength && uDistance < buffers.distances[u]) {
+                    buffers.distances[u] = uDistance;
+                    bounds.buckets[uDistance % nBuckets].push_back(u);
+                    ++nQueued;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    
+    for (uint32_t k = 0; k < nLocal; ++k) {
+        records[bounds.searchList[k]].distance = buffers.distances[k];
+    }
+    
+    return infinity;  // vertices outside the region are out of reach
+}
+
+// Depth-first enumeration on an explicit stack: the search list holds the
+// current path, the child field of each vertex on the path holds the next
+// neighbor (edge index) to try from it and its distance field the number of
+// steps taken to reach it
+Generator<std::span<const uint32_t>> Graph::enumerateSimplePaths(
+    const uint32_t source, const uint32_t pathLength, const bool isBoeg) const
+{
+    // Borrow (freshly reset) query structure
+    ScopedQuery scopedQuery = acquireQuery();
+    GraphQuery &query = *scopedQuery;
+    query.reset();
+    
+    uint32_t *path = query.searchList.data();
+    path[0] = source;
+    if (pathLength == 0) {
+        co_yield std::span<const uint32_t>(path, 1);
+        co_return;
+    }
+    if (pathLength > static_cast<uint64_t>(nVertices - 1) * maxWeight) {
+        co_return;  // no simple path can be that long
+    }
+    
+    // Visit source
+    query.visit(source);
+    query.records[source].child = vertexBounds(source, isBoeg).first;
+    query.records[source].distance = 0;
+    uint32_t depth = 0;  // number of edges on current path
+    while (true) {
+        const uint32_t v = path[depth];
+        const uint32_t end = vertexBounds(v, isBoeg).second;
+        const uint32_t remaining = pathLength - query.records[v].distance;
+        uint32_t &next = query.records[v].child;
+        while (next < end && (query.isVisited(nbors[next]) || edgeWeight(next) > remaining)) {
+            ++next;
+        }
+        
+        if (next == end) {
+            // Backtrack
+            query.unvisit(v);
+            if (depth == 0) break;
+            --depth;
+            continue;
+        }
+        
+        const uint32_t weight = edgeWeight(next);
+        const uint32_t n = nbors[next++];
+        path[depth + 1] = n;
+        if (weight == remaining) {
+            co_yield std::span<const uint32_t>(path, depth + 2);
+        } else {
+            // Move to neighbor n
+            ++depth;
+            query.visit(n);
+            query.records[n].child = vertexBounds(n, isBoeg).first;
+            query.records[n].distance = pathLength - remaining + weight;
+        }
+    }
+}
+
+Generator<uint32_t> Graph::enumerateReachableEndpoints(const uint32_t source,
+    const uint32_t pathLength, const bool isBoeg) const
+{
+    const ReachabilityIndex &index = reachabilityIndexes[isBoeg];
+    if (index.isIndexed(pathLength)) {
+        // Set bits of precomputed bitset
+        const auto words = index.getReachableSet(source, pathLength);
+        for (uint32_t w = 0; w < words.size(); ++w) {
+            for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                co_yield 64 * w + std::countr_zero(word);
+            }
+        }
+        co_return;
+    }
+    if (bitMatrix) {
+        for (const uint32_t v : bitMatrix->findReachableEndpoints(source, pathLength, isBoeg)) {
+            co_yield v;
+        }
+        co_return;
+    }
+    
+    // Marks endpoints that have already been yielded
+    ScopedQuery scopedEndpoints = acquireQuery();
+    GraphQuery &endpoints = *scopedEndpoints;
+    endpoints.reset();
+    
+    for (const auto path : enumerateSimplePaths(source, pathLength, isBoeg)) {
+        const uint32_t v = path.back();
+        if (!endpoints.isVisited(v)) {
+            endpoints.visit(v);
+            co_yield v;
+        }
+    }
+}
+
+Generator<std::span<const uint32_t>> Graph::simplePaths(const uint32_t source,
+    const uint32_t pathLength, const bool isBoeg /* = false */) const
+{
+    // Note: Validate before the (lazily started) coroutine is created
+    if (source >= nVertices)
+        throw std::invalid_argument("Invalid source vertex index");
+    
+    return enumerateSimplePaths(source, pathLength, isBoeg);
+}
+
+Generator<uint32_t> Graph::reachableEndpoints(const uint32_t source,
+    const uint32_t pathLength, const bool isBoeg /* = false */) const
+{
+    if (source >= nVertices)
+        throw std::invalid_argument("Invalid source vertex index");
+    
+    return enumerateReachableEndpoints(source, pathLength, isBoeg);
+}
+
+bool Graph::hasFittingEdge(const uint32_t v, const uint32_t remaining, const bool isBoeg,
+    const GraphQuery &query) const
+{
+    const auto [start, end] = vertexBounds(v, isBoeg);
     for (uint32_t i = start; i < end; ++i) {
-        const Edge edge = edges[i];
-        const uint32_t n = edge.nborId;
+        if (!query.isVisited(nbors[i]) && edgeWeight(i) <= remaining) return true;
+    }
+    
+    return false;
+}
+
+// Same search as enumerateSimplePaths(), which also yields paths that get
+// stuck: the end is entered (and its edges checked) before it is yielded
+Generator<std::span<const uint32_t>> Graph::enumerateMovePaths(
+    const uint32_t source, const uint32_t diceRoll, const bool isBoeg) const
+{
+    // Borrow (freshly reset) query structure
+    ScopedQuery scopedQuery = acquireQuery();
+    GraphQuery &query = *scopedQuery;
+    query.reset();
+    
+    uint32_t *path = query.searchList.data();
+    path[0] = source;
+    
+    // Visit source
+    query.visit(source);
+    if (diceRoll == 0 || !hasFittingEdge(source, diceRoll, isBoeg, query)) {
+        co_yield std::span<const uint32_t>(path, 1);  // stay put
+        co_return;
+    }
+    query.records[source].child = vertexBounds(source, isBoeg).first;
+    query.records[source].distance = 0;
+    uint32_t depth = 0;  // number of edges on current path
+    while (true) {
+        const uint32_t v = path[depth];
+        const uint32_t end = vertexBounds(v, isBoeg).second;
+        const uint32_t remaining = diceRoll - query.records[v].distance;
+        uint32_t &next = query.records[v].child;
+        while (next < end && (query.isVisited(nbors[next]) || edgeWeight(next) > remaining)) {
+            ++next;
+        }
         
-        // Check if neighbor has not been previously visited and edge
-        // to neighbor is accessible
-        const bool isEdgeAccessible = isBoeg || !edge.isBoegOnly;
-        if (isEdgeAccessible && !query.visited[n]) {
-            // Update
-            query.distances[n] = distance + 1;
-            // Recursively find all reachable vertices from neighbor n
-            findAllReachableVerticesRecursive(n, pathLength, isBoeg, reachable);
+        if (next == end) {
+            // Backtrack
+            query.unvisit(v);
+            if (depth == 0) break;
+            --depth;
+            continue;
         }
+        
+        const uint32_t weight = edgeWeight(next);
+        const uint32_t n = nbors[next++];
+        path[depth + 1] = n;
+        query.visit(n);
+        if (weight == remaining || !hasFittingEdge(n, remaining - weight, isBoeg, query)) {
+            query.unvisit(n);
+            co_yield std::span<const uint32_t>(path, depth + 2);
+        } else {
+            // Move to neighbor n
+            ++depth;
+            query.records[n].child = vertexBounds(n, isBoeg).first;
+            query.records[n].distance = diceRoll - remaining + weight;
+        }
+    }
+}
+
+Generator<uint32_t> Graph::enumerateMoveEndpoints(const uint32_t source,
+    const uint32_t diceRoll, const bool isBoeg) const
+{
+    if (!isWeighted()) {
+        // Every move uses up the roll
+        for (const uint32_t v : enumerateReachableEndpoints(source, diceRoll, isBoeg)) {
+            co_yield v;
+        }
+        co_return;
     }
     
-    // Backtrack
-    query.visited[v] = 0;
+    // Marks endpoints that have already been yielded
+    ScopedQuery scopedEndpoints = acquireQuery();
+    GraphQuery &endpoints = *scopedEndpoints;
+    endpoints.reset();
+    
+    for (const auto path : enumerateMovePaths(source, diceRoll, isBoeg)) {
+        const uint32_t v = path.back();
+        if (!endpoints.isVisited(v)) {
+            endpoints.visit(v);
+            co_yield v;
+        }
+    }
+}
+
+Generator<uint32_t> Graph::moveEndpoints(const uint32_t source,
+    const uint32_t diceRoll, const bool isBoeg /* = false */) const
+{
+    if (source >= nVertices)
+        throw std::invalid_argument("Invalid source vertex index");
+    
+    return enumerateMoveEndpoints(source, diceRoll, isBoeg);
+}
+
+bool Graph::isCompleteMove(const std::vector<uint32_t> &path, const uint32_t diceRoll,
+    const bool isBoeg /* = false */) const
+{
+    const uint32_t pathWeight = getPathWeight(path);
+    if (pathWeight >= diceRoll || !isWeighted()) {
+        return pathWeight == diceRoll;
+    }
+    
+    // Borrow (freshly reset) query structure
+    ScopedQuery scopedQuery = acquireQuery();
+    GraphQuery &query = *scopedQuery;
+    query.reset();
+    for (const uint32_t v : path) {
+        query.visit(v);
+    }
+    
+    return !hasFittingEdge(path.back(), diceRoll - pathWeight, isBoeg, query);
+}
+
+std::vector<uint32_t> Graph::findMovePath(const uint32_t source, const uint32_t target,
+    const uint32_t diceRoll, const bool isBoeg /* = false */) const
+{
+    std::vector<uint32_t> path = findPathOfLength(source, target, diceRoll, isBoeg);
+    if (!path.empty() || !isWeighted()) return path;
+    
+    // Moves that end short
+    for (const auto movePath : enumerateMovePaths(source, diceRoll, isBoeg)) {
+        if (movePath.back() == target) return std::vector<uint32_t>(movePath.begin(), movePath.end());
+    }
+    
+    return {};  // invalid (empty) path
 }
 
 std::vector<uint32_t> Graph::findPathOfLength(const uint32_t source, 
     const uint32_t target, const uint32_t pathLength, 
-    const bool isBoeg /* = false */)
+    const bool isBoeg /* = false */) const
 {    
     if (source >= nVertices || target >= nVertices)
         throw std::invalid_argument("Invalid source/target vertex indexes");
+    
+    const ReachabilityIndex &index = reachabilityIndexes[isBoeg];
+    if (index.isIndexed(pathLength)) {
+        return index.getWitnessPath(source, target, pathLength);
+    }
+    
+    // Lengths of all paths between two vertices may share their parity
+    const std::vector<uint8_t> &parities = stepParities[isBoeg];
+    if (parities[source] != noParity &&
+        (parities[source] ^ parities[target]) != (pathLength & 1))
+    {
+        return {};
+    }
+    const bool isColorCodingLength =
+        pathLength >= colorCodingMinLength && pathLength <= maxColorfulPathLength;
+    if (bitMatrix) {
+        // Same switch to color coding as the search below
+        uint32_t visitBudget = (isColorCodingLength) ? colorCodingSwitchVisits
+                                                     : std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> path = bitMatrix->findPathOfLength(source, target, pathLength,
+            isBoeg, visitBudget);
+        if (!path.empty() || visitBudget != 0) return path;
         
-    // Reset query structure
+        path = findColorfulPath(source, target, pathLength, isBoeg);
+        if (!path.empty()) return path;
+        
+        visitBudget = std::numeric_limits<uint32_t>::max();
+        return bitMatrix->findPathOfLength(source, target, pathLength, isBoeg, visitBudget);
+    }
+    
+    // Borrow (freshly reset) query structures
+    ScopedQuery scopedBounds = acquireQuery();
+    GraphQuery &bounds = *scopedBounds;
+    bounds.reset();
+    const uint32_t outerBound = computeTargetBounds(source, target, pathLength, isBoeg, bounds);
+    if (targetBound(bounds, source, outerBound) > pathLength) {
+        return {};  // target too far away (or out of reach)
+    }
+    
+    ScopedQuery scopedQuery = acquireQuery();
+    GraphQuery &query = *scopedQuery;
     query.reset();
+    query.records[source].distance = 0;
+    query.candidates.clear();
     
+    // Long paths: if the depth-first search stalls, color coding usually
+    // finds a path faster. As it may miss paths, the depth-first search
+    // completes the query if color coding fails
+    uint32_t visitBudget = std::numeric_limits<uint32_t>::max();
     bool isPathFound = false;
-    isPathFound = findPathOfLengthRecursive(source, target, pathLength, isBoeg);
+    if (isColorCodingLength) {
+        visitBudget = colorCodingSwitchVisits;
+        isPathFound = findPathOfLengthRecursive(source, target, pathLength, isBoeg, query,
+            bounds, outerBound, visitBudget);
+        if (!isPathFound && visitBudget == 0) {
+            std::vector<uint32_t> path = searchColorfulPath(source, target, pathLength,
+                isBoeg, colorCodingTrials, bounds, outerBound);
+            if (!path.empty()) return path;
+            
+            // Note: The aborted search left no vertex visited
+            visitBudget = std::numeric_limits<uint32_t>::max();
+        }
+    }
+    if (!isPathFound && visitBudget != 0) {
+        isPathFound = findPathOfLengthRecursive(source, target, pathLength, isBoeg, query,
+            bounds, outerBound, visitBudget);
+    }
     
     if (!isPathFound) {
         //throw std::runtime_error(
@@ -389,9 +1222,13 @@ std::vector<uint32_t> Graph::findPathOfLength(const uint32_t source,
     }
     
     // Prepare final output
-    std::vector<uint32_t> path(pathLength + 1);  // + 1 for source (starting position)
-    for (uint32_t v = source, i = 0; i <= pathLength; v = query.children[v], ++i) {
-        path[i] = v;
+    // Note: Distances of path vertices count steps, which reach pathLength
+    //       at target only
+    std::vector<uint32_t> path(1, source);  // source (starting position)
+    path.reserve(pathLength + 1);
+    for (uint32_t v = source; query.records[v].distance != pathLength; ) {
+        v = query.records[v].child;
+        path.push_back(v);
     }
     
     return path;
@@ -399,101 +1236,75 @@ std::vector<uint32_t> Graph::findPathOfLength(const uint32_t source,
 
 std::unordered_set<uint32_t> Graph::findAllReachableVertices(
     const uint32_t source, const uint32_t pathLength, 
-    const bool isBoeg /* = false */)
+    const bool isBoeg /* = false */) const
 {
-    if (source >= nVertices)
-        throw std::invalid_argument("Invalid source vertex index");
-        
-    // Reset query structure
-    query.reset();
-    
     std::unordered_set<uint32_t> reachable;
-    findAllReachableVerticesRecursive(source, pathLength, isBoeg, reachable);
+    for (const uint32_t v : reachableEndpoints(source, pathLength, isBoeg)) {
+        reachable.insert(v);
+    }
     
     return reachable;
 }
 
+uint32_t Graph::getPathWeight(const std::vector<uint32_t> &path) const
+{
+    if (!isWeighted()) {
+        return (path.empty()) ? 0 : static_cast<uint32_t>(path.size() - 1);
+    }
+    
+    uint32_t weight = 0;
+    for (std::size_t i = 0; i + 1 < path.size(); ++i) {
+        const std::size_t edge = findNbor(path[i], path[i + 1]);
+        if (edge == nbors.size()) throw std::invalid_argument("Path is not connected");
+        
+        weight += weights[edge];
+    }
+    
+    return weight;
+}
+
 bool Graph::isValidPath(const std::vector<uint32_t> &path, 
-    const uint32_t source, const bool isBoeg)
+    const uint32_t source, const bool isBoeg) const
 {
     if (path.size() == 0) return false;  // empty path
     if (path.size() == 1) return path.front() == source;  // trivial path
     if (path.front() != source) return false;
+    if (bitMatrix) return bitMatrix->isValidPath(path, source, isBoeg);
     
-    // Reset query structure
+    // Borrow (freshly reset) query structure
+    ScopedQuery scopedQuery = acquireQuery();
+    GraphQuery &query = *scopedQuery;
     query.reset();
     
     for (auto u = path.begin(), v = path.begin() + 1;
             v < path.end(); ++u, ++v)
     {
         // Visit this vertex
-        query.visited[*u] = 1;
-        
-        bool foundNeighbor = false;
-        const auto [start, end] = vertexBounds(*u);
-        for (uint32_t i = start; i < end; ++i) {
-            const Edge e = edges[i];
-            const uint32_t n = e.nborId;
-            
-            const bool isEdgeAccessible = isBoeg || !e.isBoegOnly;
-            if (n == *v && !query.visited[n] && isEdgeAccessible) {
-                foundNeighbor = true;
-                break;
-            }
-        }
+        query.visit(*u);
         
-        if (!foundNeighbor) return false;
+        const auto [start, end] = vertexBounds(*u, isBoeg);
+        const auto nbor = std::find(nbors.begin() + start, nbors.begin() + end, *v);
+        if (nbor == nbors.begin() + end || query.isVisited(*v)) return false;
     }
     
     return true;
 }
 
-std::pair<uint32_t,uint32_t> Graph::vertexBounds(const uint32_t v) const
-{
-    assert(v < nVertices && "Invalid vertex index");
-    
-    return std::pair(offsets[v], offsets[v + 1]);
-}
-
-std::vector<LineVertex> Graph::getLinesFromEdges() const
+std::vector<Edge> Graph::getEdges() const
 {
-    std::vector<LineVertex> lines;
-    if (graphType == GRAPH_DIRECTED)
-    {
-        lines.reserve(2 * edges.size());  // 2 Line vertices per edge
-    }
-    else  // graphType == GRAPH_UNDIRECTED
-    {
-        lines.reserve(edges.size());  // every edge is already counted twice
-    }
+    std::vector<Edge> edges;
+    edges.reserve(getNEdges());
     
-    for (uint32_t vertexId = 0; vertexId < vertices.size(); ++vertexId)
-    {
-        const auto [start, end] = vertexBounds(vertexId);
-        for (uint32_t i = start; i < end; ++i)
-        {
-            const Edge edge = edges[i];
-            
-            if (graphType == GRAPH_UNDIRECTED && vertexId > edge.nborId)
-            {
+    for (uint32_t vertexId = 0; vertexId < nVertices; ++vertexId) {
+        const auto [start, end] = vertexBounds(vertexId, true);
+        for (uint32_t i = start; i < end; ++i) {
+            const uint32_t nborId = nbors[i];
+            if (graphType == GRAPH_UNDIRECTED && vertexId > nborId) {
                 continue;  // already added this edge in opposite direction
             }
-            
-            const auto &startVertex = vertices[vertexId];
-            const auto &endVertex = vertices[edge.nborId];
-            
-            if (edge.isBoegOnly)  // "boeg" edges are white
-            {
-                lines.push_back({{startVertex.xpos, startVertex.ypos}, {0.9f, 0.9f, 0.9f}});
-                lines.push_back({{endVertex.xpos, endVertex.ypos}, {0.9f, 0.9f, 0.9f}});
-            }
-            else  // regular edges are black
-            {
-                lines.push_back({{startVertex.xpos, startVertex.ypos}, {0.0f, 0.0f, 0.0f}});
-                lines.push_back({{endVertex.xpos, endVertex.ypos}, {0.0f, 0.0f, 0.0f}});
-            }
+            edges.push_back({vertexId, nborId, i >= regularEnds[vertexId]});
         }
     }
     
-    return lines;
+    return edges;
 }
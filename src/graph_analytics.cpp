@@ -0,0 +1,314 @@
+#include <fangpp/graph.hpp>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+namespace {
+
+// Run fn(thread, i) for every i in [0, n) on 'nThreads' threads. Threads
+// fetch one index at a time, as searches from different sources differ in
+// cost (e.g., on directed boards)
+template <typename F>
+void parallelForEach(const uint32_t nThreads, const uint32_t n, const F &fn)
+{
+    std::atomic<uint32_t> next(0);
+    const auto work = [&next, n, &fn](const uint32_t thread) {
+        for (uint32_t i = next++; i < n; i = next++) {
+            fn(thread, i);
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (uint32_t thread = 1; thread < std::min(nThreads, n); ++thread) {
+        workers.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+// Per-thread state of betweenness accumulation
+struct BrandesState {
+    std::vector<double> centrality;    // dependencies summed over sources of thread
+    std::vector<double> paths;         // number of shortest paths from source
+    std::vector<double> coefficients;  // (1 + dependency) / paths of each vertex
+};
+
+}  // namespace
+
+// Brandes' algorithm: a search from each source visits vertices by
+// increasing distance, which orders shortest paths. Counting them forward
+// and summing dependencies backward along edges that lie on a shortest path
+// (distance grows by the edge weight) needs no predecessor lists. The
+// dependency of v sums paths(v) / paths(n) * (1 + dependency(n)) over its
+// successors n, so the second factor is kept per vertex to save a division
+// per edge. Each thread sums into its own centrality array
+// Note: Path counts are floating point, as they grow exponentially on
+//       grid-like boards. Parallel edges count as separate paths
+BoardAnalytics Graph::computeAnalytics(const bool isBoeg /* = false */,
+    const AnalyticsOptions &options /* = AnalyticsOptions() */) const
+{
+    const uint32_t nThreads = std::max(1u,
+        (options.nThreads > 0) ? options.nThreads : std::thread::hardware_concurrency());
+    
+    BoardAnalytics analytics;
+    analytics.betweenness.assign(nVertices, 0.0);
+    analytics.eccentricities.assign(nVertices, 0);
+    
+    std::vector<uint32_t> sources(nVertices);
+    std::iota(sources.begin(), sources.end(), 0);
+    const bool isSampled = options.nSamples > 0 && options.nSamples < nVertices;
+    if (isSampled) {
+        std::mt19937 prng(options.seed);
+        std::shuffle(sources.begin(), sources.end(), prng);
+        sources.resize(options.nSamples);
+    }
+    
+    std::vector<BrandesState> states(nThreads);
+    parallelForEach(nThreads, static_cast<uint32_t>(sources.size()),
+        [&](const uint32_t thread, const uint32_t k)
+    {
+        BrandesState &state = states[thread];
+        if (state.centrality.empty()) {
+            state.centrality.assign(nVertices, 0.0);
+            state.paths.resize(nVertices);
+            state.coefficients.resize(nVertices);
+        }
+        
+        const uint32_t source = sources[k];
+        ScopedQuery scopedQuery = acquireQuery();
+        GraphQuery &query = *scopedQuery;
+        query.reset();
+        const uint32_t nVisited = (isWeighted()) ? dialSearch(source, query, isBoeg)
+                                                 : breadthFirstSearch(source, query, isBoeg);
+        const QueryRecord *records = query.records.data();
+        const uint32_t *order = query.searchList.data();
+        
+        // Note: Out-neighbors of visited vertices are visited as well
+        for (uint32_t i = 0; i < nVisited; ++i) {
+            state.paths[order[i]] = 0.0;
+        }
+        state.paths[source] = 1.0;
+        for (uint32_t i = 0; i < nVisited; ++i) {
+            const uint32_t v = order[i];
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t j = start; j < end; ++j) {
+                const uint32_t n = nbors[j];
+                if (records[n].distance == records[v].distance + edgeWeight(j)) {
+                    state.paths[n] += state.paths[v];
+                }
+            }
+        }
+        // Note: Successors come later in search order, so their
+        //       coefficients are final when v is reached
+        for (uint32_t i = nVisited; i-- > 1; ) {
+            const uint32_t v = order[i];
+            double sum = 0.0;
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t j = start; j < end; ++j) {
+                const uint32_t n = nbors[j];
+                if (records[n].distance == records[v].distance + edgeWeight(j)) {
+                    sum += state.coefficients[n];
+                }
+            }
+            const double dependency = state.paths[v] * sum;
+            state.centrality[v] += dependency;
+            state.coefficients[v] = (1.0 + dependency) / state.paths[v];
+        }
+        
+        analytics.eccentricities[source] = records[order[nVisited - 1]].distance;
+    });
+    
+    // Sampled sources stand for all of them. Undirected boards count every
+    // pair twice (once from either end)
+    double scale = (isSampled) ? static_cast<double>(nVertices) / options.nSamples : 1.0;
+    if (graphType == GRAPH_UNDIRECTED) scale /= 2.0;
+    for (const BrandesState &state : states) {
+        if (state.centrality.empty()) continue;  // thread got no source
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            analytics.betweenness[v] += scale * state.centrality[v];
+        }
+    }
+    
+    if (isSampled && graphType == GRAPH_UNDIRECTED) {
+        analytics.eccentricities = boundEccentricities(isBoeg, nThreads);
+    } else if (isSampled) {
+        // Directed distances are not symmetric, which the bounds rely on
+        parallelForEach(nThreads, nVertices, [&](const uint32_t, const uint32_t source) {
+            ScopedQuery scopedQuery = acquireQuery();
+            GraphQuery &query = *scopedQuery;
+            query.reset();
+            const uint32_t nVisited = (isWeighted()) ? dialSearch(source, query, isBoeg)
+                                                     : breadthFirstSearch(source, query, isBoeg);
+            analytics.eccentricities[source] = query.records[query.searchList[nVisited - 1]].distance;
+        });
+    }
+    
+    analytics.radius = std::numeric_limits<uint32_t>::max();
+    for (const uint32_t eccentricity : analytics.eccentricities) {
+        analytics.diameter = std::max(analytics.diameter, eccentricity);
+        if (eccentricity > 0) analytics.radius = std::min(analytics.radius, eccentricity);
+    }
+    if (analytics.diameter == 0) analytics.radius = 0;  // no edges
+    
+    computeTargetDistances(analytics, isBoeg, nThreads);
+    
+    return analytics;
+}
+
+// Bounding eccentricities (Takes & Kosters, 2011): a search from v yields
+// ecc(v) and, as distances are symmetric, bounds
+//   max(d(v, w), ecc(v) - d(v, w)) <= ecc(w) <= ecc(v) + d(v, w)
+// for every w in the component of v. Searches start from vertices whose
+// bounds are still apart, alternately from the smallest lower and the
+// largest upper bound, until all bounds meet. Each round runs one search
+// per thread
+std::vector<uint32_t> Graph::boundEccentricities(const bool isBoeg,
+    const uint32_t nThreads) const
+{
+    assert(graphType == GRAPH_UNDIRECTED && "bounds require symmetric distances");
+    
+    std::vector<uint32_t> lower(nVertices, 0);
+    std::vector<uint32_t> upper(nVertices, std::numeric_limits<uint32_t>::max());
+    std::vector<uint32_t> degrees(nVertices);
+    std::vector<uint32_t> open;  // vertices whose bounds are apart
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        degrees[v] = end - start;
+        if (degrees[v] == 0) {
+            upper[v] = 0;  // isolated
+        } else {
+            open.push_back(v);
+        }
+    }
+    
+    std::vector<ScopedQuery> queries;
+    for (uint32_t thread = 0; thread < nThreads; ++thread) {
+        queries.push_back(acquireQuery());
+    }
+    std::vector<uint32_t> picks;
+    std::vector<uint8_t> isPicked(nVertices, 0);
+    bool isLowerPick = true;
+    while (!open.empty()) {
+        // Ties go to vertices of larger degree
+        picks.clear();
+        while (picks.size() < std::min<std::size_t>(nThreads, open.size())) {
+            uint32_t best = nVertices;
+            for (const uint32_t v : open) {
+                if (isPicked[v]) continue;
+                if (best == nVertices) {
+                    best = v;
+                } else if (isLowerPick) {
+                    if (std::tie(lower[v], degrees[best]) < std::tie(lower[best], degrees[v])) best = v;
+                } else {
+                    if (std::tie(upper[best], degrees[best]) < std::tie(upper[v], degrees[v])) best = v;
+                }
+            }
+            isPicked[best] = 1;
+            picks.push_back(best);
+            isLowerPick = !isLowerPick;
+        }
+        
+        std::vector<uint32_t> nVisited(picks.size());
+        parallelForEach(nThreads, static_cast<uint32_t>(picks.size()),
+            [&](const uint32_t, const uint32_t k)
+        {
+            GraphQuery &query = *queries[k];
+            query.reset();
+            nVisited[k] = (isWeighted()) ? dialSearch(picks[k], query, isBoeg)
+                                         : breadthFirstSearch(picks[k], query, isBoeg);
+        });
+        
+        for (std::size_t k = 0; k < picks.size(); ++k) {
+            const GraphQuery &query = *queries[k];
+            const uint32_t eccentricity = query.records[query.searchList[nVisited[k] - 1]].distance;
+            for (uint32_t i = 0; i < nVisited[k]; ++i) {
+                const uint32_t w = query.searchList[i];
+                const uint32_t distance = query.records[w].distance;
+                lower[w] = std::max({lower[w], distance, eccentricity - distance});
+                upper[w] = std::min(upper[w], eccentricity + distance);
+            }
+            isPicked[picks[k]] = 0;
+        }
+        
+        std::erase_if(open, [&lower, &upper](const uint32_t v) { return lower[v] == upper[v]; });
+    }
+    
+    return upper;
+}
+
+// Boards have far fewer targets than stations, so every target searches
+// backward along incoming edges (Dial's bucket queue as in dialSearch(),
+// which degenerates to BFS on unweighted boards) and counts the stations it
+// reaches. Targets are searched in parallel
+void Graph::computeTargetDistances(BoardAnalytics &analytics, const bool isBoeg,
+    const uint32_t nThreads) const
+{
+    // Incoming edges of each vertex (source, weight)
+    std::vector<uint32_t> inOffsets(nVertices + 1, 0);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        for (uint32_t j = start; j < end; ++j) {
+            ++inOffsets[nbors[j] + 1];
+        }
+    }
+    std::partial_sum(inOffsets.begin(), inOffsets.end(), inOffsets.begin());
+    std::vector<uint32_t> inNbors(inOffsets.back());
+    std::vector<uint8_t> inWeights(inOffsets.back());
+    std::vector<uint32_t> fill(inOffsets.begin(), inOffsets.end() - 1);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        for (uint32_t j = start; j < end; ++j) {
+            const uint32_t i = fill[nbors[j]]++;
+            inNbors[i] = v;
+            inWeights[i] = static_cast<uint8_t>(edgeWeight(j));
+        }
+    }
+    
+    const uint32_t nTargets = static_cast<uint32_t>(targetVertices.size());
+    analytics.targetDistanceCounts.assign(nTargets, {});
+    analytics.unreachableStations.assign(nTargets, 0);
+    std::vector<std::vector<uint32_t>> distances(nThreads);
+    std::vector<std::vector<std::vector<uint32_t>>> buckets(nThreads);
+    parallelForEach(nThreads, nTargets, [&](const uint32_t thread, const uint32_t j) {
+        std::vector<uint32_t> &distance = distances[thread];
+        std::vector<std::vector<uint32_t>> &bucket = buckets[thread];
+        distance.assign(nVertices, std::numeric_limits<uint32_t>::max());
+        bucket.resize(maxWeight + 1);
+        
+        distance[targetVertices[j]] = 0;
+        bucket[0].push_back(targetVertices[j]);
+        uint32_t nQueued = 1;
+        for (uint32_t d = 0; nQueued > 0; ++d) {
+            std::vector<uint32_t> &current = bucket[d % bucket.size()];
+            // Note: Weights lie in [1, maxWeight], so no entry goes to the
+            //       bucket being drained
+            for (std::size_t k = 0; k < current.size(); ++k) {
+                const uint32_t v = current[k];
+                if (distance[v] != d) continue;  // outdated entry
+                for (uint32_t i = inOffsets[v]; i < inOffsets[v + 1]; ++i) {
+                    const uint32_t n = inNbors[i];
+                    if (d + inWeights[i] < distance[n]) {
+                        distance[n] = d + inWeights[i];
+                        bucket[distance[n] % bucket.size()].push_back(n);
+                        ++nQueued;
+                    }
+                }
+            }
+            nQueued -= static_cast<uint32_t>(current.size());
+            current.clear();
+        }
+        
+        std::vector<uint32_t> &distanceCounts = analytics.targetDistanceCounts[j];
+        for (const uint32_t station : stationVertices) {
+            if (distance[station] == std::numeric_limits<uint32_t>::max()) {
+                ++analytics.unreachableStations[j];
+                continue;
+            }
+            if (distanceCounts.size() <= distance[station]) distanceCounts.resize(distance[station] + 1, 0);
+            ++distanceCounts[distance[station]];
+        }
+    });
+}
@@ -0,0 +1,343 @@
+#include <fangpp/graph.hpp>
+
+#include <bit>
+
+namespace {
+
+// Set of vertex ids below N, 64 per word
+template <uint32_t N>
+struct BitRow {
+    static_assert(N % 64 == 0, "vertex bound must fill whole words");
+    static constexpr const uint32_t nWords = N / 64;
+    
+    bool test(const uint32_t v) const { return (words[v / 64] >> (v % 64)) & 1; }
+    
+    void set(const uint32_t v) { words[v / 64] |= uint64_t(1) << (v % 64); }
+    
+    void reset(const uint32_t v) { words[v / 64] &= ~(uint64_t(1) << (v % 64)); }
+    
+    BitRow &operator|=(const BitRow &other)
+    {
+        for (uint32_t w = 0; w < nWords; ++w) words[w] |= other.words[w];
+        return *this;
+    }
+    
+    BitRow &operator&=(const BitRow &other)
+    {
+        for (uint32_t w = 0; w < nWords; ++w) words[w] &= other.words[w];
+        return *this;
+    }
+    
+    // Remove all ids of other
+    BitRow &subtract(const BitRow &other)
+    {
+        for (uint32_t w = 0; w < nWords; ++w) words[w] &= ~other.words[w];
+        return *this;
+    }
+    
+    // Smallest id in set (N if empty)
+    uint32_t first() const
+    {
+        for (uint32_t w = 0; w < nWords; ++w) {
+            if (words[w] != 0) return 64 * w + std::countr_zero(words[w]);
+        }
+        return N;
+    }
+    
+    // Smallest id in both sets (N if there is none)
+    uint32_t firstCommon(const BitRow &other) const
+    {
+        for (uint32_t w = 0; w < nWords; ++w) {
+            const uint64_t word = words[w] & other.words[w];
+            if (word != 0) return 64 * w + std::countr_zero(word);
+        }
+        return N;
+    }
+    
+    // Smallest id in set but not in other (N if there is none)
+    uint32_t firstMissing(const BitRow &other) const
+    {
+        for (uint32_t w = 0; w < nWords; ++w) {
+            const uint64_t word = words[w] & ~other.words[w];
+            if (word != 0) return 64 * w + std::countr_zero(word);
+        }
+        return N;
+    }
+    
+    // Call f for every id in set, by increasing id
+    template <typename Function>
+    void forEach(Function &&f) const
+    {
+        for (uint32_t w = 0; w < nWords; ++w) {
+            for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                f(64 * w + std::countr_zero(word));
+            }
+        }
+    }
+    
+    std::array<uint64_t, nWords> words{};
+};
+
+template <uint32_t N>
+class FixedBitMatrixEngine final : public BitMatrixEngine {
+public:
+    void setEdge(const uint32_t u, const uint32_t v, const bool isBoegOnly) override
+    {
+        assert(u < N && v < N && "vertex exceeds bound of engine");
+        
+        // Note: The Boeg may use all edges
+        outRows[1][u].set(v);
+        inRows[1][v].set(u);
+        if (!isBoegOnly) {
+            outRows[0][u].set(v);
+            inRows[0][v].set(u);
+        }
+    }
+    
+    void clearEdge(const uint32_t u, const uint32_t v) override
+    {
+        assert(u < N && v < N && "vertex exceeds bound of engine");
+        
+        for (uint32_t isBoeg = 0; isBoeg < 2; ++isBoeg) {
+            outRows[isBoeg][u].reset(v);
+            inRows[isBoeg][v].reset(u);
+        }
+    }
+    
+    bool hasEdge(const uint32_t u, const uint32_t v, const bool isBoeg) const override
+    {
+        return u < N && v < N && outRows[isBoeg][u].test(v);
+    }
+    
+    // Each level ORs the rows of its vertices and removes visited ones. The
+    // parent of a vertex is the first frontier vertex among its incoming
+    // neighbors
+    uint32_t breadthFirstSearch(const uint32_t source, GraphQuery &spQuery,
+        const bool isBoeg) const override
+    {
+        const std::array<Row, N> &out = outRows[isBoeg];
+        const std::array<Row, N> &in = inRows[isBoeg];
+        QueryRecord *records = spQuery.records.data();
+        uint32_t *searchList = spQuery.searchList.data();
+        
+        searchList[0] = source;
+        records[source] = {0, source, spQuery.generation};
+        Row visited, frontier;
+        visited.set(source);
+        frontier.set(source);
+        
+        uint32_t head = 0, tail = 1;
+        for (uint32_t distance = 1; head < tail; ++distance) {
+            Row next;
+            for (uint32_t i = head; i < tail; ++i) {
+                next |= out[searchList[i]];
+            }
+            next.subtract(visited);
+            visited |= next;
+            
+            head = tail;
+            next.forEach([&](const uint32_t n) {
+                records[n] = {distance, in[n].firstCommon(frontier), spQuery.generation};
+                searchList[tail++] = n;
+            });
+            frontier = next;
+        }
+        
+        return tail;
+    }
+    
+    // Depth-first search as Graph::findPathOfLength(), but the vertices
+    // within d steps of target are a bitset for every d, so the neighbors
+    // worth trying are one AND of rows away. Neighbors whose shortest path
+    // to target takes all remaining steps are tried first. Every vertex
+    // moved to uses up one visit of the budget
+    std::vector<uint32_t> findPathOfLength(const uint32_t source,
+        const uint32_t target, const uint32_t pathLength, const bool isBoeg,
+        uint32_t &visitBudget) const override
+    {
+        if (pathLength == 0) {
+            return (source == target) ? std::vector<uint32_t>(1, source) : std::vector<uint32_t>();
+        }
+        if (source == target || pathLength >= N) {
+            return {};  // no simple path ends where it started or has N edges
+        }
+        const std::array<Row, N> &out = outRows[isBoeg];
+        if (pathLength == 1) {
+            return (out[source].test(target)) ? std::vector<uint32_t>{source, target}
+                                              : std::vector<uint32_t>();
+        }
+        
+        // Vertices at most d steps from target (BFS along incoming edges)
+        static thread_local std::vector<Row> withinSteps;
+        withinSteps.assign(pathLength, Row());
+        withinSteps[0].set(target);
+        Row frontier = withinSteps[0];
+        for (uint32_t d = 1; d < pathLength; ++d) {
+            Row next;
+            frontier.forEach([&](const uint32_t f) { next |= inRows[isBoeg][f]; });
+            withinSteps[d] = withinSteps[d - 1];
+            withinSteps[d] |= next;
+            frontier = next.subtract(withinSteps[d - 1]);
+        }
+        
+        // Candidates of each path vertex: unvisited neighbors other than
+        // target that can reach target in the remaining steps
+        static thread_local std::vector<Row> candidates;
+        candidates.resize(pathLength);
+        std::vector<uint32_t> path(pathLength + 1);
+        Row onPath;
+        const auto expand = [&](const uint32_t depth) {
+            Row &next = candidates[depth];
+            next = out[path[depth]];
+            next &= withinSteps[pathLength - depth - 1];
+            next.subtract(onPath);
+            next.reset(target);
+        };
+        
+        path[0] = source;
+        onPath.set(source);
+        expand(0);
+        uint32_t depth = 0;
+        while (true) {
+            const uint32_t remaining = pathLength - depth;  // steps left after path[depth]
+            Row &next = candidates[depth];
+            uint32_t n = next.firstMissing(withinSteps[remaining - 2]);
+            if (n == N) n = next.first();
+            
+            if (n == N) {
+                // Backtrack
+                if (depth == 0) return {};
+                onPath.reset(path[depth]);
+                --depth;
+                continue;
+            }
+            next.reset(n);
+            path[depth + 1] = n;
+            if (remaining == 2) {
+                // Note: Candidates of the last but one step neighbor target
+                path[depth + 2] = target;
+                return path;
+            }
+            
+            // Move to neighbor n
+            if (visitBudget == 0) return {};  // search stalled
+            --visitBudget;
+            ++depth;
+            onPath.set(n);
+            expand(depth);
+        }
+    }
+    
+    bool isValidPath(const std::vector<uint32_t> &path, const uint32_t source,
+        const bool isBoeg) const override
+    {
+        if (path.size() == 0) return false;  // empty path
+        if (path.size() == 1) return path.front() == source;  // trivial path
+        if (path.front() != source) return false;
+        
+        Row onPath;
+        for (std::size_t i = 0; i + 1 < path.size(); ++i) {
+            onPath.set(path[i]);
+            if (!hasEdge(path[i], path[i + 1], isBoeg) || onPath.test(path[i + 1])) return false;
+        }
+        
+        return true;
+    }
+    
+    // Enumerates simple paths of pathLength - 2 edges, from whose end the
+    // last two steps reach the unvisited neighbors of all candidates at once
+    std::vector<uint32_t> findReachableEndpoints(const uint32_t source,
+        const uint32_t pathLength, const bool isBoeg) const override
+    {
+        if (pathLength == 0) return std::vector<uint32_t>(1, source);
+        if (pathLength >= N) return {};
+        const std::array<Row, N> &out = outRows[isBoeg];
+        
+        Row onPath, endpoints;
+        onPath.set(source);
+        if (pathLength == 1) {
+            endpoints = out[source];
+            endpoints.subtract(onPath);
+        } else {
+            static thread_local std::vector<Row> candidates;
+            candidates.resize(pathLength - 1);
+            std::vector<uint32_t> path(pathLength - 1);
+            
+            path[0] = source;
+            candidates[0] = out[source];
+            candidates[0].subtract(onPath);
+            uint32_t depth = 0;
+            while (true) {
+                Row &next = candidates[depth];
+                if (depth + 2 == pathLength) {
+                    next.forEach([&](const uint32_t n) {
+                        Row reached = out[n];
+                        endpoints |= reached.subtract(onPath);
+                    });
+                    next = Row();
+                }
+                
+                const uint32_t n = next.first();
+                if (n == N) {
+                    // Backtrack
+                    if (depth == 0) break;
+                    onPath.reset(path[depth]);
+                    --depth;
+                    continue;
+                }
+                next.reset(n);
+                
+                // Move to neighbor n
+                ++depth;
+                path[depth] = n;
+                onPath.set(n);
+                candidates[depth] = out[n];
+                candidates[depth].subtract(onPath);
+            }
+        }
+        
+        std::vector<uint32_t> reachable;
+        endpoints.forEach([&reachable](const uint32_t v) { reachable.push_back(v); });
+        
+        return reachable;
+    }
+
+private:
+    using Row = BitRow<N>;
+    
+    std::array<std::array<Row, N>, 2> outRows;  // out-neighbors of each vertex (regular, Boeg)
+    std::array<std::array<Row, N>, 2> inRows;   // in-neighbors of each vertex (regular, Boeg)
+};
+
+}  // namespace
+
+std::unique_ptr<BitMatrixEngine> BitMatrixEngine::create(const uint32_t nVertices)
+{
+    if (nVertices <= 128) return std::make_unique<FixedBitMatrixEngine<128>>();
+    if (nVertices <= 256) return std::make_unique<FixedBitMatrixEngine<256>>();
+    if (nVertices <= maxVertices) return std::make_unique<FixedBitMatrixEngine<maxVertices>>();
+    
+    return nullptr;
+}
+
+// Note: Rows hold no weights
+void Graph::buildBitMatrix()
+{
+    bitMatrix = (isWeighted()) ? nullptr : BitMatrixEngine::create(nVertices);
+    if (!bitMatrix) return;
+    
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+            bitMatrix->setEdge(v, nbors[i], i >= regularEnds[v]);
+        }
+    }
+}
+
+void Graph::updateBitMatrix(const uint32_t u, const uint32_t v)
+{
+    bitMatrix->clearEdge(u, v);
+    const std::size_t i = findNbor(u, v);
+    if (i != nbors.size()) {
+        bitMatrix->setEdge(u, v, i >= regularEnds[u]);
+    }
+}
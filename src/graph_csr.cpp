@@ -0,0 +1,198 @@
+#include <fangpp/graph.hpp>
+
+#include <thread>
+
+namespace {
+
+// Run fn(thread, begin, end) on 'nThreads' threads for consecutive chunks
+// of [0, n), chunk i on thread i
+template <typename F>
+void parallelChunks(const uint32_t nThreads, const std::size_t n, const F &fn)
+{
+    const auto chunkBegin = [nThreads, n](const uint32_t thread) {
+        return n * thread / nThreads;
+    };
+    
+    std::vector<std::thread> workers;
+    for (uint32_t thread = 1; thread < nThreads; ++thread) {
+        workers.emplace_back(fn, thread, chunkBegin(thread), chunkBegin(thread + 1));
+    }
+    fn(0u, chunkBegin(0), chunkBegin(1));
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace
+
+CSRBuilder::CSRBuilder(const uint32_t _nThreads /* = 0 */) :
+    nThreads(std::max(1u, (_nThreads > 0) ? _nThreads : std::thread::hardware_concurrency())) {}
+
+// Histograms hold the regular degrees of all vertices followed by their
+// Boeg-only degrees. After counting, the entry of each thread turns into
+// the number of slots earlier threads take, so that a thread's first slot
+// of vertex v is the start of v's regular (or Boeg-only) neighbors plus its
+// entry
+// Note: Threads are limited such that their histograms do not outgrow the
+//       edge list
+CSRAdjacency CSRBuilder::build(const uint32_t nVertices, const bool isUndirected,
+    const std::vector<uint32_t> &edgeSources,
+    const std::vector<uint32_t> &edgeTargets,
+    const std::vector<uint8_t> &edgeBoegFlags,
+    const std::vector<uint8_t> &edgeWeights) const
+{
+    assert(edgeSources.size() == edgeTargets.size() &&
+           edgeSources.size() == edgeBoegFlags.size());
+    assert(edgeWeights.empty() || edgeWeights.size() == edgeSources.size());
+    
+    const std::size_t nInputEdges = edgeSources.size();
+    const uint32_t nChunks = static_cast<uint32_t>(std::max<std::size_t>(1, std::min({
+        static_cast<std::size_t>(nThreads),
+        nInputEdges / minEdgesPerThread,
+        nInputEdges / std::max(1u, nVertices)
+    })));
+    
+    // Count (regular) outdegree of each vertex per chunk of edges
+    std::vector<std::vector<uint32_t>> histograms(nChunks);
+    std::vector<uint8_t> maxWeights(nChunks, 1);
+    parallelChunks(nChunks, nInputEdges,
+        [&](const uint32_t chunk, const std::size_t begin, const std::size_t end)
+    {
+        std::vector<uint32_t> &counts = histograms[chunk];
+        counts.assign(2 * static_cast<std::size_t>(nVertices), 0);
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::size_t boegOffset = (edgeBoegFlags[i]) ? nVertices : 0;
+            ++counts[boegOffset + edgeSources[i]];
+            if (isUndirected) {
+                // Also add edge going in opposite direction
+                ++counts[boegOffset + edgeTargets[i]];
+            }
+        }
+        if (!edgeWeights.empty() && begin < end) {
+            maxWeights[chunk] = *std::max_element(edgeWeights.begin() + begin, edgeWeights.begin() + end);
+        }
+    });
+    
+    CSRAdjacency adjacency;
+    computeOffsets(nVertices, histograms, adjacency);
+    
+    adjacency.maxWeight = *std::max_element(maxWeights.begin(), maxWeights.end());
+    const bool isWeightStored = (adjacency.maxWeight > 1);
+    
+    // Fill neighbor (and weight) array
+    const uint32_t nEdges = adjacency.offsets[nVertices];
+    adjacency.nbors.resize(nEdges);
+    adjacency.weights.assign((isWeightStored) ? nEdges : 0, 1);
+    parallelChunks(nChunks, nInputEdges,
+        [&](const uint32_t chunk, const std::size_t begin, const std::size_t end)
+    {
+        std::vector<uint32_t> &counts = histograms[chunk];
+        // Next slot of a vertex's regular or Boeg-only neighbors in this chunk
+        const auto slot = [&](const uint32_t v, const bool isBoegOnly) {
+            return (isBoegOnly) ? adjacency.regularEnds[v] + counts[nVertices + v]++
+                                : adjacency.offsets[v] + counts[v]++;
+        };
+        
+        for (std::size_t i = begin; i < end; ++i) {
+            const uint32_t sourceIndex = edgeSources[i];
+            const uint32_t targetIndex = edgeTargets[i];
+            // Store index of target vertex in bucket of source vertex
+            const uint32_t sourceSlot = slot(sourceIndex, edgeBoegFlags[i]);
+            adjacency.nbors[sourceSlot] = targetIndex;
+            if (isWeightStored) adjacency.weights[sourceSlot] = edgeWeights[i];
+            if (isUndirected) {
+                const uint32_t targetSlot = slot(targetIndex, edgeBoegFlags[i]);
+                adjacency.nbors[targetSlot] = sourceIndex;
+                if (isWeightStored) adjacency.weights[targetSlot] = edgeWeights[i];
+            }
+        }
+    });
+    
+    return adjacency;
+}
+
+void CSRBuilder::computeOffsets(const uint32_t nVertices,
+    std::vector<std::vector<uint32_t>> &histograms, CSRAdjacency &adjacency)
+{
+    // Degrees of each vertex (in offsets[v + 1]) and slots taken by earlier
+    // chunks (in histograms)
+    adjacency.offsets.resize(nVertices + 1);
+    adjacency.offsets[0] = 0;  // starting offset
+    adjacency.regularEnds.resize(nVertices);
+    const uint32_t nChunks = static_cast<uint32_t>(histograms.size());
+    std::vector<uint32_t> blockSums(nChunks);
+    parallelChunks(nChunks, nVertices,
+        [&](const uint32_t block, const std::size_t begin, const std::size_t end)
+    {
+        uint32_t blockSum = 0;
+        for (std::size_t v = begin; v < end; ++v) {
+            uint32_t nRegular = 0, nBoegOnly = 0;
+            for (std::vector<uint32_t> &counts : histograms) {
+                const uint32_t regularCount = counts[v];
+                const uint32_t boegOnlyCount = counts[nVertices + v];
+                counts[v] = nRegular;
+                counts[nVertices + v] = nBoegOnly;
+                nRegular += regularCount;
+                nBoegOnly += boegOnlyCount;
+            }
+            adjacency.regularEnds[v] = nRegular;
+            adjacency.offsets[v + 1] = nRegular + nBoegOnly;
+            blockSum += nRegular + nBoegOnly;
+        }
+        blockSums[block] = blockSum;
+    });
+    
+    // Prefix sum over vertices: blocks of vertices start after the degrees
+    // of all earlier blocks
+    std::exclusive_scan(blockSums.begin(), blockSums.end(), blockSums.begin(), 0u);
+    parallelChunks(nChunks, nVertices,
+        [&](const uint32_t block, const std::size_t begin, const std::size_t end)
+    {
+        uint32_t offset = blockSums[block];
+        for (std::size_t v = begin; v < end; ++v) {
+            // Boeg-only neighbors follow regular ones
+            adjacency.regularEnds[v] += offset;
+            offset += adjacency.offsets[v + 1];
+            adjacency.offsets[v + 1] = offset;
+        }
+    });
+}
+
+// The counting pass gathers degrees by id. Once ids are resolved, they make
+// up the histogram of a single chunk, and the sink's counts turn into the
+// slots taken of each vertex
+CSRAdjacency CSRBuilder::build(const std::function<void(EdgeSink &)> &forEachEdge,
+    const std::function<uint32_t(std::vector<uint32_t> &)> &resolveIds) const
+{
+    EdgeSink sink;
+    forEachEdge(sink);
+    
+    const uint32_t nVertices = resolveIds(sink.vertexIndexes);
+    assert(sink.regularCounts.size() <= sink.vertexIndexes.size() &&
+           sink.boegOnlyCounts.size() <= sink.vertexIndexes.size());
+    sink.regularCounts.resize(sink.vertexIndexes.size(), 0);
+    sink.boegOnlyCounts.resize(sink.vertexIndexes.size(), 0);
+    std::vector<std::vector<uint32_t>> histograms(1);
+    std::vector<uint32_t> &counts = histograms[0];
+    counts.assign(2 * static_cast<std::size_t>(nVertices), 0);
+    for (std::size_t id = 0; id < sink.vertexIndexes.size(); ++id) {
+        const uint32_t v = sink.vertexIndexes[id];
+        counts[v] += sink.regularCounts[id];
+        counts[nVertices + v] += sink.boegOnlyCounts[id];
+    }
+    
+    CSRAdjacency adjacency;
+    computeOffsets(nVertices, histograms, adjacency);
+    adjacency.maxWeight = sink.maxWeight;
+    
+    const uint32_t nEdges = adjacency.offsets[nVertices];
+    adjacency.nbors.resize(nEdges);
+    adjacency.weights.assign((adjacency.maxWeight > 1) ? nEdges : 0, 1);
+    sink.regularCounts.assign(nVertices, 0);
+    sink.boegOnlyCounts.assign(nVertices, 0);
+    sink.adjacency = &adjacency;
+    sink.isFillPass = true;
+    forEachEdge(sink);
+    
+    return adjacency;
+}
@@ -0,0 +1,516 @@
+#include <fangpp/graph.hpp>
+
+#include <limits>
+#include <queue>
+
+bool Graph::insertEdge(const uint32_t u, const uint32_t v, const bool isBoegOnly /* = false */,
+    const uint32_t weight /* = 1 */)
+{
+    if (u >= nVertices || v >= nVertices) {
+        throw std::invalid_argument("Invalid vertex id of edge");
+    }
+    if (u == v) {
+        throw std::invalid_argument("Edge must join two distinct vertices");
+    }
+    if (weight < 1 || weight > maxEdgeWeight) {
+        throw std::invalid_argument("Invalid edge weight");
+    }
+    if (hasEdge(u, v)) return false;
+    
+    // Labels offer no cheap repair: shortest paths fall back to searches
+    distanceOracles = {};
+    if (weight != 1 && !isWeighted()) {
+        // Board becomes weighted, which the reachability index cannot express
+        weights.assign(nbors.size(), 1);
+        reachabilityIndexes = {};
+        bitMatrix = nullptr;
+    }
+    maxWeight = std::max(maxWeight, weight);
+    
+    insertNbor(u, v, isBoegOnly, weight);
+    nEdges += 1;
+    if (graphType == GRAPH_UNDIRECTED) {
+        insertNbor(v, u, isBoegOnly, weight);
+        nEdges += 1;
+    }
+    if (bitMatrix) {
+        updateBitMatrix(u, v);
+        if (graphType == GRAPH_UNDIRECTED) updateBitMatrix(v, u);
+    }
+    // Note: Cheap next to the table updates below (near-linear in the edges)
+    stepParities = {computeStepParities(false), computeStepParities(true)};
+    
+    // Note: Boeg-only edges do not exist for the regular tables
+    if (hasDistanceTables()) {
+        if (!isBoegOnly) insertIntoDistanceTable(u, v, weight, false);
+        insertIntoDistanceTable(u, v, weight, true);
+    }
+    if (hasReachabilityIndex()) {
+        // Note: Paths may outgrow the budget of the index, which is dropped then
+        const bool isReindexed = (isBoegOnly || reindexSources(findSourcesNear(u, v, false), false)) &&
+                                 reindexSources(findSourcesNear(u, v, true), true);
+        if (!isReindexed) reachabilityIndexes = {};
+    }
+    
+    return true;
+}
+
+bool Graph::removeEdge(const uint32_t u, const uint32_t v)
+{
+    if (u >= nVertices || v >= nVertices) {
+        throw std::invalid_argument("Invalid vertex id of edge");
+    }
+    
+    const std::size_t i = findNbor(u, v);
+    if (i == nbors.size()) return false;
+    
+    const bool isBoegOnly = (i >= regularEnds[u]);
+    const uint32_t weight = edgeWeight(i);
+    distanceOracles = {};  // see insertEdge()
+    
+    // Sources whose index rows use the edge (or neighbor order around it)
+    // must be found while the edge still exists
+    std::array<std::vector<uint32_t>, 2> nearSources;
+    if (hasReachabilityIndex()) {
+        if (!isBoegOnly) nearSources[0] = findSourcesNear(u, v, false);
+        nearSources[1] = findSourcesNear(u, v, true);
+    }
+    
+    removeNbor(u, i);
+    nEdges -= 1;
+    if (graphType == GRAPH_UNDIRECTED) {
+        removeNbor(v, findNbor(v, u));
+        nEdges -= 1;
+    }
+    
+    // Without edges of weight other than 1, the board plays by the rules of
+    // unweighted boards again (and gets its bit matrix back)
+    const auto hasWeightedEdge = [this]()
+    {
+        for (uint32_t w = 0; w < nVertices; ++w) {
+            for (uint32_t j = offsets[w]; j < nborEnds[w]; ++j) {
+                if (weights[j] != 1) return true;
+            }
+        }
+        
+        return false;
+    };
+    if (weight != 1 && !hasWeightedEdge()) {
+        weights.clear();
+        weights.shrink_to_fit();
+        maxWeight = 1;
+        buildBitMatrix();
+    } else if (bitMatrix) {
+        updateBitMatrix(u, v);
+        if (graphType == GRAPH_UNDIRECTED) updateBitMatrix(v, u);
+    }
+    stepParities = {computeStepParities(false), computeStepParities(true)};
+    
+    if (hasDistanceTables()) {
+        if (!isBoegOnly) removeFromDistanceTable(u, v, weight, false);
+        removeFromDistanceTable(u, v, weight, true);
+    }
+    if (hasReachabilityIndex()) {
+        const bool isReindexed = (isBoegOnly || reindexSources(nearSources[0], false)) &&
+                                 reindexSources(nearSources[1], true);
+        if (!isReindexed) reachabilityIndexes = {};
+    }
+    
+    return true;
+}
+
+bool Graph::hasEdge(const uint32_t u, const uint32_t v) const
+{
+    if (bitMatrix) return u < nVertices && v < nVertices && bitMatrix->hasEdge(u, v, true);
+    
+    return u < nVertices && v < nVertices && findNbor(u, v) != nbors.size();
+}
+
+std::size_t Graph::findNbor(const uint32_t u, const uint32_t v) const
+{
+    const auto first = nbors.begin() + offsets[u];
+    const auto last  = nbors.begin() + nborEnds[u];
+    const auto it = std::find(first, last, v);
+    
+    return (it != last) ? static_cast<std::size_t>(it - nbors.begin()) : nbors.size();
+}
+
+void Graph::insertNbor(const uint32_t u, const uint32_t v, const bool isBoegOnly,
+    const uint32_t weight)
+{
+    if (nborEnds[u] == offsets[u + 1]) {
+        makeRoom(u);
+    }
+    
+    // Slot of new neighbor
+    uint32_t i = nborEnds[u]++;
+    if (!isBoegOnly) {
+        // First Boeg-only neighbor moves to the end, making room at the end
+        // of the regular neighbors
+        nbors[i] = nbors[regularEnds[u]];
+        if (isWeighted()) weights[i] = weights[regularEnds[u]];
+        i = regularEnds[u]++;
+    }
+    nbors[i] = v;
+    if (isWeighted()) weights[i] = static_cast<uint8_t>(weight);
+}
+
+void Graph::removeNbor(const uint32_t u, const std::size_t i)
+{
+    assert(i >= offsets[u] && i < nborEnds[u] && "invalid neighbor index");
+    
+    const auto move = [this](const std::size_t from, const std::size_t to)
+    {
+        nbors[to] = nbors[from];
+        if (isWeighted()) weights[to] = weights[from];
+    };
+    
+    if (i < regularEnds[u]) {
+        // Last regular neighbor fills the gap, last Boeg-only neighbor the
+        // gap this leaves at the end of the regular neighbors
+        move(--regularEnds[u], i);
+        move(nborEnds[u] - 1, regularEnds[u]);
+    } else {
+        move(nborEnds[u] - 1, i);
+    }
+    --nborEnds[u];
+}
+
+// Give the (full) neighbor list of u a free slot. The lists following u are
+// shifted by one entry up to the next list with a free slot. If there is
+// none nearby, all lists are spaced out anew
+void Graph::makeRoom(const uint32_t u)
+{
+    uint32_t w = u + 1;
+    while (w < nVertices && w - u <= maxShiftedLists && nborEnds[w] == offsets[w + 1]) {
+        ++w;
+    }
+    
+    if (w < nVertices && w - u <= maxShiftedLists) {
+        std::copy_backward(nbors.begin() + offsets[u + 1], nbors.begin() + nborEnds[w],
+            nbors.begin() + nborEnds[w] + 1);
+        if (isWeighted()) {
+            std::copy_backward(weights.begin() + offsets[u + 1], weights.begin() + nborEnds[w],
+                weights.begin() + nborEnds[w] + 1);
+        }
+        for (uint32_t x = u + 1; x <= w; ++x) {
+            ++offsets[x];
+            ++regularEnds[x];
+            ++nborEnds[x];
+        }
+    } else {
+        std::vector<uint32_t> newOffsets, newRegularEnds, newNborEnds, newNbors;
+        std::vector<uint8_t> newWeights;
+        spaceAdjacency(edgeSlack, newOffsets, newRegularEnds, newNborEnds, newNbors, newWeights);
+        offsets = std::move(newOffsets);
+        regularEnds = std::move(newRegularEnds);
+        nborEnds = std::move(newNborEnds);
+        nbors = std::move(newNbors);
+        weights = std::move(newWeights);
+    }
+}
+
+void Graph::spaceAdjacency(const uint32_t slack, std::vector<uint32_t> &newOffsets,
+    std::vector<uint32_t> &newRegularEnds, std::vector<uint32_t> &newNborEnds,
+    std::vector<uint32_t> &newNbors, std::vector<uint8_t> &newWeights) const
+{
+    newOffsets.resize(nVertices + 1);
+    newRegularEnds.resize(nVertices);
+    newNborEnds.resize(nVertices);
+    newOffsets[0] = 0;
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        newRegularEnds[v] = newOffsets[v] + (regularEnds[v] - offsets[v]);
+        newNborEnds[v] = newOffsets[v] + (nborEnds[v] - offsets[v]);
+        newOffsets[v + 1] = newNborEnds[v] + slack;
+    }
+    
+    newNbors.assign(newOffsets[nVertices], 0);
+    newWeights.assign((isWeighted()) ? newOffsets[nVertices] : 0, 1);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        std::copy(nbors.begin() + offsets[v], nbors.begin() + nborEnds[v],
+            newNbors.begin() + newOffsets[v]);
+        if (isWeighted()) {
+            std::copy(weights.begin() + offsets[v], weights.begin() + nborEnds[v],
+                newWeights.begin() + newOffsets[v]);
+        }
+    }
+}
+
+// Dynamic BFS after adding u -> v (and v -> u): in each row, the distances
+// that shrink are those of vertices reached through the new edge. Only they
+// are relaxed (outwards from the edge) and inherit the first hop of their new
+// parent. Rows whose distances do not shrink are left alone
+// Note: On weighted boards, a vertex may be relaxed more than once
+void Graph::insertIntoDistanceTable(const uint32_t u, const uint32_t v, const uint32_t weight,
+    const bool isBoeg)
+{
+    DistanceTable &table = distanceTables[isBoeg];
+    const uint32_t infinity = std::numeric_limits<uint32_t>::max();
+    const auto distance = [&table, infinity](const uint32_t s, const uint32_t t) -> uint32_t
+    {
+        const uint16_t d = table.distances[table.index(s, t)];
+        return (d != 0 || s == t) ? d : infinity;  // 0 marks unreachable targets
+    };
+    
+    std::array<std::pair<uint32_t,uint32_t>, 2> arcs = {{{u, v}, {v, u}}};
+    const std::size_t nArcs = (graphType == GRAPH_UNDIRECTED) ? 2 : 1;
+    
+    std::vector<uint32_t> queue;
+    queue.reserve(nVertices);
+    for (uint32_t s = 0; s < nVertices; ++s) {
+        uint16_t *distances = &table.distances[table.index(s, 0)];
+        uint16_t *nextHops  = &table.nextHops[table.index(s, 0)];
+        
+        for (std::size_t j = 0; j < nArcs; ++j) {
+            const auto [a, b] = arcs[j];
+            const uint32_t da = distance(s, a);
+            if (da == infinity || da + weight >= distance(s, b)) continue;
+            
+            distances[b] = static_cast<uint16_t>(da + weight);
+            nextHops[b] = (a == s) ? b : nextHops[a];
+            
+            queue.clear();
+            queue.push_back(b);
+            for (std::size_t head = 0; head < queue.size(); ++head) {
+                const uint32_t x = queue[head];
+                const auto [start, end] = vertexBounds(x, isBoeg);
+                for (uint32_t i = start; i < end; ++i) {
+                    const uint32_t n = nbors[i];
+                    const uint32_t dn = distances[x] + edgeWeight(i);
+                    if (dn < distance(s, n)) {
+                        distances[n] = static_cast<uint16_t>(dn);
+                        nextHops[n] = nextHops[x];
+                        queue.push_back(n);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Dynamic BFS after removing u -> v (and v -> u) of 'weight' steps. In a row
+// where the edge lay on a shortest path, the affected vertices are those left
+// without a parent (an in-neighbor on a shortest path) that is not affected
+// itself; they are found in order of distance from the edge. Only their
+// distances are recomputed, by a Dijkstra search seeded from unaffected
+// in-neighbors. Finally, first hops are repaired where they pointed along
+// the removed edge or to a vertex whose distance changed
+void Graph::removeFromDistanceTable(const uint32_t u, const uint32_t v, const uint32_t weight,
+    const bool isBoeg)
+{
+    DistanceTable &table = distanceTables[isBoeg];
+    const uint32_t infinity = std::numeric_limits<uint32_t>::max();
+    const auto distance = [&table, infinity](const uint32_t s, const uint32_t t) -> uint32_t
+    {
+        const uint16_t d = table.distances[table.index(s, t)];
+        return (d != 0 || s == t) ? d : infinity;  // 0 marks unreachable targets
+    };
+    
+    // In-edges: undirected boards are their own reverse, directed ones get a
+    // temporary reverse CSR (holding the index of each edge in 'nbors')
+    std::vector<uint32_t> reverseOffsets, reverseNbors, reverseEdges;
+    if (graphType == GRAPH_DIRECTED) {
+        reverseOffsets.assign(nVertices + 1, 0);
+        for (uint32_t x = 0; x < nVertices; ++x) {
+            const auto [start, end] = vertexBounds(x, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                ++reverseOffsets[nbors[i] + 1];
+            }
+        }
+        std::inclusive_scan(reverseOffsets.begin(), reverseOffsets.end(), reverseOffsets.begin());
+        reverseNbors.resize(reverseOffsets[nVertices]);
+        reverseEdges.resize(reverseOffsets[nVertices]);
+        std::vector<uint32_t> fill(reverseOffsets.begin(), reverseOffsets.end() - 1);
+        for (uint32_t x = 0; x < nVertices; ++x) {
+            const auto [start, end] = vertexBounds(x, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                reverseEdges[fill[nbors[i]]] = i;
+                reverseNbors[fill[nbors[i]]++] = x;
+            }
+        }
+    }
+    const uint32_t *inNbors = (graphType == GRAPH_DIRECTED) ? reverseNbors.data() : nbors.data();
+    const auto inBounds = [&](const uint32_t x) -> std::pair<uint32_t,uint32_t>
+    {
+        if (graphType == GRAPH_DIRECTED) return {reverseOffsets[x], reverseOffsets[x + 1]};
+        
+        return vertexBounds(x, isBoeg);
+    };
+    const auto inWeight = [&](const uint32_t i) -> uint32_t
+    {
+        return edgeWeight((graphType == GRAPH_DIRECTED) ? reverseEdges[i] : i);
+    };
+    
+    std::array<std::pair<uint32_t,uint32_t>, 2> arcs = {{{u, v}, {v, u}}};
+    const std::size_t nArcs = (graphType == GRAPH_UNDIRECTED) ? 2 : 1;
+    
+    // Note: Marks are row stamps (source + 1), so they need no clearing
+    std::vector<uint32_t> isQueued(nVertices, 0);
+    std::vector<uint32_t> isAffected(nVertices, 0);
+    std::vector<uint32_t> newDistances(nVertices);
+    std::vector<uint32_t> affected;
+    std::vector<std::pair<uint32_t,uint32_t>> changed;  // (source, target) pairs
+    using HeapEntry = std::pair<uint32_t,uint32_t>;     // (distance, vertex)
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> candidates, heap;
+    
+    for (uint32_t s = 0; s < nVertices; ++s) {
+        const uint32_t stamp = s + 1;
+        
+        for (std::size_t j = 0; j < nArcs; ++j) {
+            const auto [a, b] = arcs[j];
+            const uint32_t da = distance(s, a);
+            if (da != infinity && distance(s, b) == da + weight && isQueued[b] != stamp) {
+                isQueued[b] = stamp;
+                candidates.emplace(da + weight, b);
+            }
+        }
+        if (candidates.empty()) continue;  // edge was on no shortest path
+        
+        // Note: Candidates are checked in order of distance, so the parents
+        //       of a candidate have all been classified before it
+        affected.clear();
+        while (!candidates.empty()) {
+            const auto [dw, w] = candidates.top();
+            candidates.pop();
+            
+            bool hasParent = false;
+            for (auto [i, end] = inBounds(w); i < end && !hasParent; ++i) {
+                const uint32_t p = inNbors[i];
+                hasParent = isAffected[p] != stamp && distance(s, p) != infinity &&
+                            distance(s, p) + inWeight(i) == dw;
+            }
+            if (hasParent) continue;
+            
+            isAffected[w] = stamp;
+            affected.push_back(w);
+            const auto [start, end] = vertexBounds(w, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                const uint32_t n = nbors[i];
+                if (isQueued[n] != stamp && distance(s, n) == dw + edgeWeight(i)) {
+                    isQueued[n] = stamp;
+                    candidates.emplace(dw + edgeWeight(i), n);
+                }
+            }
+        }
+        
+        for (const uint32_t x : affected) {
+            uint32_t best = infinity;
+            for (auto [i, end] = inBounds(x); i < end; ++i) {
+                const uint32_t p = inNbors[i];
+                const uint32_t dp = distance(s, p);
+                if (isAffected[p] != stamp && dp != infinity) best = std::min(best, dp + inWeight(i));
+            }
+            newDistances[x] = best;
+            if (best != infinity) heap.emplace(best, x);
+        }
+        while (!heap.empty()) {
+            const auto [d, x] = heap.top();
+            heap.pop();
+            if (d != newDistances[x]) continue;  // outdated entry
+            
+            const auto [start, end] = vertexBounds(x, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                const uint32_t n = nbors[i];
+                if (isAffected[n] == stamp && d + edgeWeight(i) < newDistances[n]) {
+                    newDistances[n] = d + edgeWeight(i);
+                    heap.emplace(newDistances[n], n);
+                }
+            }
+        }
+        
+        for (const uint32_t x : affected) {
+            const uint32_t d = newDistances[x];
+            table.distances[table.index(s, x)] = (d != infinity) ? static_cast<uint16_t>(d) : 0;
+            changed.emplace_back(s, x);
+        }
+    }
+    
+    // First hop of s towards t: any out-neighbor on a shortest path to t
+    const auto repairHop = [&](const uint32_t s, const uint32_t t)
+    {
+        const uint32_t d = distance(s, t);
+        if (s == t || d == infinity) return;
+        
+        const auto [start, end] = vertexBounds(s, isBoeg);
+        for (uint32_t i = start; i < end; ++i) {
+            const uint32_t z = nbors[i];
+            if (distance(z, t) != infinity && distance(z, t) + edgeWeight(i) == d) {
+                table.nextHops[table.index(s, t)] = static_cast<uint16_t>(z);
+                return;
+            }
+        }
+        assert(false && "no neighbor on shortest path");
+    };
+    
+    for (std::size_t j = 0; j < nArcs; ++j) {
+        const auto [a, b] = arcs[j];
+        for (uint32_t t = 0; t < nVertices; ++t) {
+            if (table.nextHops[table.index(a, t)] == b) repairHop(a, t);
+        }
+    }
+    for (const auto &[y, t] : changed) {
+        repairHop(y, t);
+        for (auto [i, end] = inBounds(y); i < end; ++i) {
+            const uint32_t s = inNbors[i];
+            if (table.nextHops[table.index(s, t)] == y) repairHop(s, t);
+        }
+    }
+}
+
+// Sources from which the index search (of simple paths up to maxPathLength
+// edges) reaches u or, on undirected boards, v before its last step, i.e.,
+// all sources that may traverse the edge or see the neighbor order there
+std::vector<uint32_t> Graph::findSourcesNear(const uint32_t u, const uint32_t v,
+    const bool isBoeg) const
+{
+    std::vector<uint8_t> isNear(nVertices, 0);
+    isNear[u] = 1;
+    if (graphType == GRAPH_UNDIRECTED) isNear[v] = 1;
+    
+    // Each sweep adds the vertices one more step away
+    std::vector<uint8_t> isNearNext;
+    for (uint32_t step = 1; step < ReachabilityIndex::maxPathLength; ++step) {
+        isNearNext = isNear;
+        for (uint32_t x = 0; x < nVertices; ++x) {
+            if (isNear[x]) continue;
+            
+            const auto [start, end] = vertexBounds(x, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                if (isNear[nbors[i]]) {
+                    isNearNext[x] = 1;
+                    break;
+                }
+            }
+        }
+        isNear.swap(isNearNext);
+    }
+    
+    std::vector<uint32_t> sources;
+    for (uint32_t x = 0; x < nVertices; ++x) {
+        if (isNear[x]) sources.push_back(x);
+    }
+    
+    return sources;
+}
+
+bool Graph::reindexSources(const std::vector<uint32_t> &sources, const bool isBoeg)
+{
+    ReachabilityIndex &index = reachabilityIndexes[isBoeg];
+    
+    std::array<uint32_t, ReachabilityIndex::maxPathLength + 1> path;
+    std::vector<uint8_t> visited(nVertices, 0);
+    uint64_t nVisitsLeft = ReachabilityIndex::maxPathVisits;
+    for (const uint32_t source : sources) {
+        for (uint32_t k = 1; k <= ReachabilityIndex::maxPathLength; ++k) {
+            const auto first = index.reachable.begin() + index.setIndex(source, k);
+            std::fill(first, first + index.nWords, 0);
+        }
+        
+        path[0] = source;
+        if (!indexSimplePathsRecursive(source, 0, path, visited, index, nVisitsLeft, isBoeg)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
@@ -0,0 +1,143 @@
+#include <fangpp/graph.hpp>
+
+namespace {
+
+// SplitMix64 finalizer, used to color vertices without storing colors
+uint64_t mixBits(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    
+    return x;
+}
+
+// Color coding state key (colors of path vertices, end vertex)
+struct ColorKey {
+    uint64_t colors;
+    uint32_t vertex;
+    
+    bool operator==(const ColorKey &other) const = default;
+};
+
+struct ColorKeyHash {
+    std::size_t operator()(const ColorKey &key) const
+    {
+        return mixBits(key.colors ^ (static_cast<uint64_t>(key.vertex) << 7));
+    }
+};
+
+}  // namespace
+
+// Color coding (Alon, Yuster and Zwick, 1995): every trial colors vertices
+// randomly and searches for a colorful path, i.e., one whose vertices all
+// differ in color. Such paths are simple by construction, so the search only
+// needs to track the set of colors used so far instead of the vertices.
+// States (vertex, color set) are expanded in order of steps taken, each at
+// most once per number of steps, which bounds a trial by the number of color
+// sets per vertex instead of the number of paths. Twice as many colors as
+// path vertices keep the chance that a given path is colorful high enough
+// for a few trials to suffice. States that cannot reach target in the
+// remaining steps are pruned with the bounds of the exact search. Colorings
+// are derived from source, target and path length, so results are
+// reproducible
+std::vector<uint32_t> Graph::findColorfulPath(const uint32_t source,
+    const uint32_t target, const uint32_t pathLength, const bool isBoeg /* = false */,
+    const uint32_t nTrials /* = colorCodingTrials */) const
+{
+    if (source >= nVertices || target >= nVertices)
+        throw std::invalid_argument("Invalid source/target vertex indexes");
+    if (pathLength > maxColorfulPathLength)
+        throw std::invalid_argument("Path length exceeds color coding limit");
+    
+    if (pathLength == 0 || source == target) {
+        return (pathLength == 0 && source == target) ? std::vector<uint32_t>(1, source)
+                                                     : std::vector<uint32_t>();
+    }
+    
+    ScopedQuery scopedBounds = acquireQuery();
+    GraphQuery &bounds = *scopedBounds;
+    bounds.reset();
+    const uint32_t outerBound = computeTargetBounds(source, target, pathLength, isBoeg, bounds);
+    if (targetBound(bounds, source, outerBound) > pathLength) {
+        return {};  // target too far away (or out of reach)
+    }
+    
+    return searchColorfulPath(source, target, pathLength, isBoeg, nTrials, bounds, outerBound);
+}
+
+std::vector<uint32_t> Graph::searchColorfulPath(const uint32_t source,
+    const uint32_t target, const uint32_t pathLength, const bool isBoeg,
+    const uint32_t nTrials, const GraphQuery &bounds, const uint32_t outerBound) const
+{
+    struct State {
+        uint64_t colors;  // colors of path vertices
+        uint32_t vertex;  // end of path
+        uint32_t parent;  // index of state before last step
+    };
+    std::vector<State> states;
+    std::vector<std::vector<uint32_t>> stepStates(pathLength + 1);  // state indexes per steps
+    std::vector<std::unordered_set<ColorKey, ColorKeyHash>> seen(pathLength + 1);  // per steps
+    
+    const uint32_t nColors = std::min(maxColors, (pathLength + 1) * colorCodingColorFactor);
+    for (uint32_t trial = 0; trial < nTrials; ++trial) {
+        const uint64_t seed = mixBits((static_cast<uint64_t>(source) << 32 | target) ^
+                                      mixBits(static_cast<uint64_t>(pathLength) << 32 | trial));
+        const auto colorBit = [seed, nColors](const uint32_t v) {
+            return uint64_t(1) << (mixBits(seed ^ v) % nColors);
+        };
+        
+        states.clear();
+        for (uint32_t steps = 0; steps <= pathLength; ++steps) {
+            stepStates[steps].clear();
+            seen[steps].clear();
+        }
+        states.push_back({colorBit(source), source, 0});
+        stepStates[0].push_back(0);
+        
+        bool isTrialExhausted = false;
+        for (uint32_t steps = 0; steps < pathLength && !isTrialExhausted; ++steps) {
+            for (const uint32_t index : stepStates[steps]) {
+                const State state = states[index];  // copy, 'states' may grow
+                const auto [start, end] = vertexBounds(state.vertex, isBoeg);
+                for (uint32_t i = start; i < end; ++i) {
+                    const uint32_t n = nbors[i];
+                    const uint32_t nSteps = steps + edgeWeight(i);
+                    // Note: Target ends the path (and no other vertex does)
+                    if (nSteps > pathLength || (n == target) != (nSteps == pathLength)) continue;
+                    if (targetBound(bounds, n, outerBound) > pathLength - nSteps) continue;
+                    
+                    const uint64_t bit = colorBit(n);
+                    if (state.colors & bit) continue;  // path would not be colorful
+                    
+                    const uint64_t colors = state.colors | bit;
+                    if (!seen[nSteps].insert({colors, n}).second) {
+                        continue;  // state reached before by a path of same steps
+                    }
+                    states.push_back({colors, n, index});
+                    
+                    if (n == target) {
+                        std::vector<uint32_t> path;
+                        for (uint32_t s = static_cast<uint32_t>(states.size() - 1); ; s = states[s].parent) {
+                            path.push_back(states[s].vertex);
+                            if (s == 0) break;
+                        }
+                        std::reverse(path.begin(), path.end());
+                        
+                        return path;
+                    }
+                    stepStates[nSteps].push_back(static_cast<uint32_t>(states.size() - 1));
+                }
+                
+                if (states.size() > maxColorCodingStates) {
+                    isTrialExhausted = true;  // try another coloring
+                    break;
+                }
+            }
+        }
+    }
+    
+    return {};  // no colorful path in any trial
+}
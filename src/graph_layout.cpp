@@ -0,0 +1,301 @@
+#include <thread>
+#include <random>
+#include <cmath>
+
+#include <fangpp/graph.hpp>
+
+namespace {
+
+// Barnes-Hut quadtree over vertex positions. Cells are split into four
+// quadrants until they hold at most leafSize vertices. Inner nodes store
+// their four children consecutively, leaves a range of 'vertexIds'
+class QuadTree {
+public:
+    void build(const std::vector<float> &_xs, const std::vector<float> &_ys)
+    {
+        xs = _xs.data();
+        ys = _ys.data();
+        vertexIds.resize(_xs.size());
+        std::iota(vertexIds.begin(), vertexIds.end(), 0);
+        
+        float xmin = xs[0], xmax = xs[0], ymin = ys[0], ymax = ys[0];
+        for (std::size_t v = 1; v < _xs.size(); ++v) {
+            xmin = std::min(xmin, xs[v]);
+            xmax = std::max(xmax, xs[v]);
+            ymin = std::min(ymin, ys[v]);
+            ymax = std::max(ymax, ys[v]);
+        }
+        
+        nodes.clear();
+        nodes.emplace_back();
+        buildRecursive(0, 0, static_cast<uint32_t>(vertexIds.size()), xmin, ymin,
+            std::max(xmax - xmin, ymax - ymin), 0);
+        
+        // Leaf-ordered copy of positions, so leaves are scanned sequentially
+        leafXs.resize(vertexIds.size());
+        leafYs.resize(vertexIds.size());
+        for (std::size_t i = 0; i < vertexIds.size(); ++i) {
+            leafXs[i] = xs[vertexIds[i]];
+            leafYs[i] = ys[vertexIds[i]];
+        }
+    }
+    
+    // Vertices in leaf order (spatially close vertices are close in order)
+    const std::vector<uint32_t> &getVertexIds() const { return vertexIds; }
+    
+    // Add repulsive forces k^2 / d of all vertices on a vertex at (x, y)
+    void addRepulsion(const float x, const float y,
+        const float theta2, const float k2, float &fx, float &fy) const
+    {
+        std::array<uint32_t, 4 * maxDepth> stack;
+        uint32_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node &node = nodes[stack[--top]];
+            
+            if (node.firstChild == 0) {
+                // Leaf: exact forces
+                // Note: Skips v itself (and vertices at the very same position)
+                //       without a branch, so the loop can be vectorized
+                for (uint32_t i = node.begin; i < node.end; ++i) {
+                    const float dx = x - leafXs[i], dy = y - leafYs[i];
+                    const float d2 = dx * dx + dy * dy;
+                    const float force = (d2 > 0.0f) ? k2 / d2 : 0.0f;
+                    fx += dx * force;
+                    fy += dy * force;
+                }
+                continue;
+            }
+            
+            const float dx = x - node.xcenter, dy = y - node.ycenter;
+            const float d2 = dx * dx + dy * dy;
+            if (node.size * node.size < theta2 * d2) {
+                // Far away cell acts as a single body at its center of mass
+                const float force = node.mass * k2 / d2;
+                fx += dx * force;
+                fy += dy * force;
+            } else {
+                for (uint32_t c = node.firstChild; c < node.firstChild + 4; ++c) {
+                    if (nodes[c].mass > 0.0f) stack[top++] = c;
+                }
+            }
+        }
+    }
+    
+    // Note: Bounds the traversal stack. Deeper cells (of almost coincident
+    //       vertices) become leaves regardless of their size
+    static constexpr const uint32_t maxDepth = 32;
+    static constexpr const uint32_t leafSize = 8;
+
+private:
+    struct Node {
+        float xcenter = 0.0f;     // center of mass
+        float ycenter = 0.0f;
+        float mass = 0.0f;        // #vertices in cell
+        float size = 0.0f;        // side length of cell
+        uint32_t firstChild = 0;  // index of first of four children (0 for leaves)
+        uint32_t begin = 0;       // range of vertices in 'vertexIds' (leaves)
+        uint32_t end = 0;
+    };
+    
+    void buildRecursive(const uint32_t index, const uint32_t begin, const uint32_t end,
+        const float x0, const float y0, const float size, const uint32_t depth)
+    {
+        nodes[index].size = size;
+        nodes[index].mass = static_cast<float>(end - begin);
+        if (end - begin <= leafSize || depth >= maxDepth) {
+            nodes[index].begin = begin;
+            nodes[index].end = end;
+            float xsum = 0.0f, ysum = 0.0f;
+            for (uint32_t i = begin; i < end; ++i) {
+                xsum += xs[vertexIds[i]];
+                ysum += ys[vertexIds[i]];
+            }
+            if (end > begin) {
+                nodes[index].xcenter = xsum / (end - begin);
+                nodes[index].ycenter = ysum / (end - begin);
+            }
+            return;
+        }
+        
+        // Split into quadrants (lower left, lower right, upper left, upper right)
+        const float half = 0.5f * size;
+        const float xmid = x0 + half, ymid = y0 + half;
+        const auto first = vertexIds.begin();
+        const auto yend = std::partition(first + begin, first + end,
+            [this, ymid](const uint32_t v) { return ys[v] < ymid; });
+        const auto lowerEnd = std::partition(first + begin, yend,
+            [this, xmid](const uint32_t v) { return xs[v] < xmid; });
+        const auto upperEnd = std::partition(yend, first + end,
+            [this, xmid](const uint32_t v) { return xs[v] < xmid; });
+        const std::array<uint32_t, 5> bounds = {
+            begin, static_cast<uint32_t>(lowerEnd - first), static_cast<uint32_t>(yend - first),
+            static_cast<uint32_t>(upperEnd - first), end
+        };
+        
+        const uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+        nodes[index].firstChild = firstChild;
+        nodes.resize(nodes.size() + 4);
+        float xsum = 0.0f, ysum = 0.0f;
+        for (uint32_t q = 0; q < 4; ++q) {
+            buildRecursive(firstChild + q, bounds[q], bounds[q + 1],
+                x0 + (q & 1) * half, y0 + (q >> 1) * half, half, depth + 1);
+            xsum += nodes[firstChild + q].mass * nodes[firstChild + q].xcenter;
+            ysum += nodes[firstChild + q].mass * nodes[firstChild + q].ycenter;
+        }
+        nodes[index].xcenter = xsum / nodes[index].mass;
+        nodes[index].ycenter = ysum / nodes[index].mass;
+    }
+    
+    std::vector<Node> nodes;
+    std::vector<uint32_t> vertexIds;  // vertices grouped by leaf
+    std::vector<float> leafXs;        // positions of 'vertexIds'
+    std::vector<float> leafYs;
+    const float *xs = nullptr;
+    const float *ys = nullptr;
+};
+
+// Strength of pull towards the center (see Graph::computeLayout())
+constexpr const float layoutGravity = 4.0f;
+
+// Run fn(begin, end) on 'nThreads' threads for consecutive chunks of [0, n)
+template <typename F>
+void parallelFor(const uint32_t nThreads, const uint32_t n, const F &fn)
+{
+    const uint32_t chunk = (n + nThreads - 1) / nThreads;
+    std::vector<std::thread> workers;
+    for (uint32_t begin = chunk; begin < n; begin += chunk) {
+        workers.emplace_back(fn, begin, std::min(n, begin + chunk));
+    }
+    fn(0u, std::min(n, chunk));
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace
+
+void Graph::computeLayout(const LayoutOptions &options /* = LayoutOptions() */)
+{
+    if (nVertices < 2) return;
+    
+    const uint32_t nThreads = std::max(1u, std::min(nVertices / 1024 + 1,
+        (options.nThreads > 0) ? options.nThreads : std::thread::hardware_concurrency()));
+    
+    // Simulate on BFS-ordered copies of positions and adjacency, so that
+    // adjacent vertices (mostly) share cache lines
+    // Note: Edges attract in both directions, so directed edges are stored
+    //       at both ends (undirected boards store them so already)
+    const std::vector<uint32_t> order = computeBfsOrder(false);
+    std::vector<uint32_t> localIds(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        localIds[order[v]] = v;
+    }
+    std::vector<uint32_t> layoutOffsets(nVertices + 1, 0);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        layoutOffsets[localIds[v] + 1] += nborEnds[v] - offsets[v];
+        if (graphType == GRAPH_DIRECTED) {
+            for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+                layoutOffsets[localIds[nbors[i]] + 1] += 1;
+            }
+        }
+    }
+    std::inclusive_scan(layoutOffsets.begin(), layoutOffsets.end(), layoutOffsets.begin());
+    std::vector<uint32_t> layoutNbors(layoutOffsets[nVertices]);
+    std::vector<uint32_t> fill(layoutOffsets.begin(), layoutOffsets.end() - 1);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+            layoutNbors[fill[localIds[v]]++] = localIds[nbors[i]];
+            if (graphType == GRAPH_DIRECTED) {
+                layoutNbors[fill[localIds[nbors[i]]]++] = localIds[v];
+            }
+        }
+    }
+    
+    // Simulate around the unit square with ideal edge length k
+    std::vector<float> xs(nVertices), ys(nVertices);
+    float xmin = vertices[0].xpos, xmax = xmin, ymin = vertices[0].ypos, ymax = ymin;
+    for (const Vertex &vert : vertices) {
+        xmin = std::min(xmin, vert.xpos);
+        xmax = std::max(xmax, vert.xpos);
+        ymin = std::min(ymin, vert.ypos);
+        ymax = std::max(ymax, vert.ypos);
+    }
+    const float extent = std::max(xmax - xmin, ymax - ymin);
+    const bool isRandomStart = options.isRandomStart || !(extent > 0.0f);
+    if (isRandomStart) {
+        std::mt19937 prng(options.seed);
+        std::uniform_real_distribution<float> coordinate(0.0f, 1.0f);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            xs[v] = coordinate(prng);
+            ys[v] = coordinate(prng);
+        }
+    } else {
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            xs[v] = (vertices[order[v]].xpos - xmin) / extent;
+            ys[v] = (vertices[order[v]].ypos - ymin) / extent;
+        }
+    }
+    
+    const float k = 1.0f / std::sqrt(static_cast<float>(nVertices));
+    const float k2 = k * k;
+    const float theta2 = options.theta * options.theta;
+    // Note: Existing layouts are only refined, random ones need larger steps
+    const float startTemperature = (isRandomStart) ? 0.1f : std::min(0.1f, 4.0f * k);
+    
+    QuadTree tree;
+    std::vector<float> dxs(nVertices), dys(nVertices);
+    for (uint32_t iteration = 0; iteration < options.nIterations; ++iteration) {
+        tree.build(xs, ys);
+        
+        parallelFor(nThreads, nVertices, [&](const uint32_t begin, const uint32_t end)
+        {
+            // Note: Visiting vertices in leaf order makes consecutive tree
+            //       traversals take (almost) the same path
+            for (uint32_t j = begin; j < end; ++j) {
+                const uint32_t v = tree.getVertexIds()[j];
+                float fx = 0.0f, fy = 0.0f;
+                tree.addRepulsion(xs[v], ys[v], theta2, k2, fx, fy);
+                
+                // Attraction d^2 / k towards neighbors
+                for (uint32_t i = layoutOffsets[v]; i < layoutOffsets[v + 1]; ++i) {
+                    const uint32_t n = layoutNbors[i];
+                    const float dx = xs[n] - xs[v], dy = ys[n] - ys[v];
+                    const float d = std::sqrt(dx * dx + dy * dy);
+                    fx += dx * d / k;
+                    fy += dy * d / k;
+                }
+                
+                // Gravity towards the center of the unit square keeps
+                // components together. Balanced against repulsion (sum of
+                // n * k^2 = 1) it yields a disk of uniform density and
+                // radius 1 / sqrt(gravity)
+                dxs[v] = fx - layoutGravity * (xs[v] - 0.5f);
+                dys[v] = fy - layoutGravity * (ys[v] - 0.5f);
+            }
+        });
+        
+        // Move at most 'temperature' (cooling linearly)
+        const float temperature = startTemperature * (1.0f -
+            static_cast<float>(iteration) / options.nIterations);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            const float length = std::sqrt(dxs[v] * dxs[v] + dys[v] * dys[v]);
+            if (length == 0.0f) continue;
+            
+            const float step = std::min(length, temperature) / length;
+            xs[v] += dxs[v] * step;
+            ys[v] += dys[v] * step;
+        }
+    }
+    
+    // Center bounding box and scale it (keeping aspect) into [-0.95, 0.95]
+    xmin = *std::min_element(xs.begin(), xs.end());
+    xmax = *std::max_element(xs.begin(), xs.end());
+    ymin = *std::min_element(ys.begin(), ys.end());
+    ymax = *std::max_element(ys.begin(), ys.end());
+    const float scale = 1.9f / std::max({xmax - xmin, ymax - ymin, 1e-6f});
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        vertices[order[v]].xpos = (xs[v] - 0.5f * (xmin + xmax)) * scale;
+        vertices[order[v]].ypos = (ys[v] - 0.5f * (ymin + ymax)) * scale;
+    }
+}
@@ -0,0 +1,250 @@
+#include <fangpp/graph.hpp>
+
+bool Graph::precomputeDistanceOracle()
+{
+    DistanceOracle regularOracle = computeDistanceOracle(false);
+    if (regularOracle.isEmpty()) return false;
+    DistanceOracle boegOracle = computeDistanceOracle(true);
+    if (boegOracle.isEmpty()) return false;
+    
+    distanceOracles[0] = std::move(regularOracle);
+    distanceOracles[1] = std::move(boegOracle);
+    
+    return true;
+}
+
+// Pruned landmark labeling: vertices become hubs one after another, most
+// central first. A search from each hub (Dial's bucket queue, i.e., plain BFS on
+// unweighted boards) adds the hub to the label of every vertex it reaches,
+// unless the labels built so far already yield a path that short. Such a
+// vertex is not expanded either, so later searches only cover the parts of
+// the board earlier hubs do not. On directed boards, a forward search fills
+// in-labels and a backward search (along reversed edges) out-labels
+DistanceOracle Graph::computeDistanceOracle(const bool isBoeg) const
+{
+    const bool isDirected = (graphType == GRAPH_DIRECTED);
+    const uint32_t infinity = std::numeric_limits<uint32_t>::max();
+    using LabelEntry = DistanceOracle::LabelEntry;
+    
+    // Incoming edges of directed boards (with the index of each in 'nbors')
+    std::vector<uint32_t> reverseOffsets, reverseNbors, reverseEdges;
+    if (isDirected) {
+        reverseOffsets.assign(nVertices + 1, 0);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                ++reverseOffsets[nbors[i] + 1];
+            }
+        }
+        std::inclusive_scan(reverseOffsets.begin(), reverseOffsets.end(), reverseOffsets.begin());
+        reverseNbors.resize(reverseOffsets[nVertices]);
+        reverseEdges.resize(reverseOffsets[nVertices]);
+        std::vector<uint32_t> fill(reverseOffsets.begin(), reverseOffsets.end() - 1);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            const auto [start, end] = vertexBounds(v, isBoeg);
+            for (uint32_t i = start; i < end; ++i) {
+                reverseEdges[fill[nbors[i]]] = i;
+                reverseNbors[fill[nbors[i]]++] = v;
+            }
+        }
+    }
+    
+    // Hubs found early should lie on many shortest paths, which prunes later
+    // searches. The number of descendants of a vertex in shortest path trees
+    // of sampled roots estimates this (degree alone fails on grid-like
+    // boards, where almost all vertices have the same degree)
+    ScopedQuery scopedQuery = acquireQuery();
+    GraphQuery &query = *scopedQuery;
+    std::vector<uint64_t> coverage(nVertices, 0);
+    std::vector<uint32_t> descendants(nVertices);
+    const uint32_t nSamples = std::min(nVertices, oracleSampleRoots);
+    for (uint32_t k = 0; k < nSamples; ++k) {
+        const uint32_t root = static_cast<uint32_t>(static_cast<uint64_t>(k) * nVertices / nSamples);
+        query.reset();
+        const uint32_t nVisited = (isWeighted()) ? dialSearch(root, query, isBoeg)
+                                                 : breadthFirstSearch(root, query, isBoeg);
+        for (uint32_t i = 0; i < nVisited; ++i) {
+            descendants[query.searchList[i]] = 1;
+        }
+        // Note: Parents are visited before their children
+        for (uint32_t i = nVisited; i-- > 1; ) {
+            const uint32_t v = query.searchList[i];
+            descendants[query.records[v].child] += descendants[v];
+            coverage[v] += descendants[v];
+        }
+        coverage[root] += descendants[root];
+    }
+    std::vector<uint32_t> degrees(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        degrees[v] += end - start;
+        if (isDirected) {
+            for (uint32_t i = start; i < end; ++i) ++degrees[nbors[i]];
+        }
+    }
+    std::vector<uint32_t> order(nVertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&coverage, &degrees](const uint32_t a, const uint32_t b) {
+        return std::tie(coverage[a], degrees[a]) > std::tie(coverage[b], degrees[b]);
+    });
+    
+    // Labels under construction. Hubs are appended in order of their rank,
+    // so labels stay sorted
+    std::vector<std::vector<LabelEntry>> inLabels(nVertices);
+    std::vector<std::vector<LabelEntry>> outLabels((isDirected) ? nVertices : 0);
+    std::vector<std::vector<LabelEntry>> &sourceLabels = (isDirected) ? outLabels : inLabels;
+    const std::size_t maxEntries = static_cast<std::size_t>(DistanceOracle::maxAverageLabelSize) * nVertices;
+    std::size_t nEntries = 0;
+    
+    // Distances between the current hub and the hubs in its own label
+    std::vector<uint32_t> hubDistances(nVertices, infinity);
+    const uint32_t nBuckets = maxWeight + 1;
+    if (query.buckets.size() < nBuckets) {
+        query.buckets.resize(nBuckets);
+    }
+    
+    // Search from hub, adding it to 'labels' of reached vertices. The label
+    // of hub in the opposite direction prunes the search
+    const auto prunedSearch = [&](const uint32_t rank, const uint32_t hub,
+        const std::vector<LabelEntry> &hubLabel, std::vector<std::vector<LabelEntry>> &labels,
+        const bool isForward)
+    {
+        for (const LabelEntry &entry : hubLabel) {
+            hubDistances[entry.hub] = entry.distance;
+        }
+        // Note: The hub label grows during the search (by the hub itself)
+        const std::size_t hubLabelSize = hubLabel.size();
+        
+        query.reset();
+        QueryRecord *records = query.records.data();
+        records[hub] = {0, hub, query.generation};
+        query.buckets[0].push_back(hub);
+        uint32_t nQueued = 1;
+        for (uint32_t distance = 0; nQueued > 0; ++distance) {
+            std::vector<uint32_t> &bucket = query.buckets[distance % nBuckets];
+            for (std::size_t j = 0; j < bucket.size(); ++j) {
+                const uint32_t v = bucket[j];
+                --nQueued;
+                if (records[v].distance != distance) continue;  // outdated entry
+                
+                // Prune if earlier hubs already cover the distance
+                std::vector<LabelEntry> &label = labels[v];
+                bool isCovered = false;
+                for (const LabelEntry &entry : label) {
+                    const uint32_t hubDistance = hubDistances[entry.hub];
+                    if (hubDistance != infinity && hubDistance + entry.distance <= distance) {
+                        isCovered = true;
+                        break;
+                    }
+                }
+                if (isCovered) continue;
+                
+                label.push_back({rank, distance});
+                ++nEntries;
+                
+                const auto relax = [&](const uint32_t n, const uint32_t weight)
+                {
+                    const uint32_t nDistance = distance + weight;
+                    if (records[n].stamp != query.generation || nDistance < records[n].distance) {
+                        records[n] = {nDistance, v, query.generation};
+                        query.buckets[nDistance % nBuckets].push_back(n);
+                        ++nQueued;
+                    }
+                };
+                if (isForward) {
+                    const auto [start, end] = vertexBounds(v, isBoeg);
+                    for (uint32_t i = start; i < end; ++i) relax(nbors[i], edgeWeight(i));
+                } else {
+                    for (uint32_t i = reverseOffsets[v]; i < reverseOffsets[v + 1]; ++i) {
+                        relax(reverseNbors[i], edgeWeight(reverseEdges[i]));
+                    }
+                }
+            }
+            bucket.clear();
+        }
+        
+        for (std::size_t i = 0; i < hubLabelSize; ++i) {
+            hubDistances[hubLabel[i].hub] = infinity;
+        }
+    };
+    
+    for (uint32_t rank = 0; rank < nVertices; ++rank) {
+        const uint32_t hub = order[rank];
+        prunedSearch(rank, hub, sourceLabels[hub], inLabels, true);
+        if (isDirected) {
+            prunedSearch(rank, hub, inLabels[hub], outLabels, false);
+        }
+        
+        if (nEntries > maxEntries) {
+            return DistanceOracle();  // labels too large
+        }
+    }
+    
+    // Concatenate labels, each followed by a sentinel
+    DistanceOracle oracle;
+    oracle.nVertices = nVertices;
+    oracle.nLabels = (isDirected) ? 2 * nVertices : nVertices;
+    oracle.labels.reserve(nEntries + oracle.nLabels);
+    const auto appendLabels = [&oracle](std::vector<std::vector<LabelEntry>> &labels,
+        std::vector<std::size_t> &offsets)
+    {
+        offsets.resize(labels.size());
+        for (std::size_t v = 0; v < labels.size(); ++v) {
+            offsets[v] = oracle.labels.size();
+            oracle.labels.insert(oracle.labels.end(), labels[v].begin(), labels[v].end());
+            oracle.labels.push_back({DistanceOracle::sentinelHub, 0});
+            std::vector<LabelEntry>().swap(labels[v]);  // release memory early
+        }
+    };
+    appendLabels(inLabels, oracle.inOffsets);
+    if (isDirected) {
+        appendLabels(outLabels, oracle.outOffsets);
+    } else {
+        oracle.outOffsets = oracle.inOffsets;
+    }
+    
+    return oracle;
+}
+
+// Note: Each step asks the oracle for the distance of every neighbor
+std::vector<uint32_t> Graph::followOraclePath(const DistanceOracle &oracle,
+    const uint32_t source, const uint32_t target, const uint32_t maxPathLength,
+    const bool isBoeg) const
+{
+    const uint32_t distance = oracle.minDistance(source, target);
+    if (distance == 0) {
+        // Either source == target or target is unreachable
+        return std::vector<uint32_t>(1, target);
+    }
+    
+    std::vector<uint32_t> path;
+    path.reserve(std::min(distance, maxPathLength) + 1);
+    path.push_back(source);
+    for (uint32_t v = source, steps = 0; v != target; ) {
+        const uint32_t remaining = oracle.minDistance(v, target);
+        
+        // Neighbor on a shortest path to target
+        const auto [start, end] = vertexBounds(v, isBoeg);
+        uint32_t i = start;
+        for ( ; i < end; ++i) {
+            const uint32_t n = nbors[i];
+            const uint32_t nRemaining = oracle.minDistance(n, target);
+            if ((nRemaining != 0 || n == target) && nRemaining + edgeWeight(i) == remaining) break;
+        }
+        assert(i < end && "no neighbor on shortest path");
+        
+        steps += edgeWeight(i);
+        if (steps > maxPathLength) break;
+        
+        v = nbors[i];
+        path.push_back(v);
+    }
+    
+    return path;
+}
+
+std::vector<uint32_t> GraphQuery::followOraclePath(const uint32_t target,
+    const uint32_t maxPathLength) const
+{
+    return graph->followOraclePath(*oracle, source, target, maxPathLength, isBoeg);
+}
@@ -0,0 +1,206 @@
+#include <fangpp/graph.hpp>
+
+#include <stdexcept>
+
+void Graph::reorderVertices(const VERTEX_ORDER order)
+{
+    // order[newId] = current id
+    std::vector<uint32_t> vertexOrder;
+    if (order == ORDER_FILE) {
+        if (internalIds.empty()) return;  // already in file order
+        vertexOrder = internalIds;
+    } else {
+        vertexOrder = computeBfsOrder(order == ORDER_RCM);
+    }
+    
+    if (vertexOrder.size() != nVertices) {
+        throw std::runtime_error("Vertex order does not cover all vertices");
+    }
+    
+    std::vector<uint32_t> newIds(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        newIds[vertexOrder[v]] = v;
+    }
+    
+    // Permute vertex data and relabel targets/stations (keeping their order,
+    // so games shuffle them identically)
+    std::vector<Vertex> newVertices(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        newVertices[v] = std::move(vertices[vertexOrder[v]]);
+    }
+    vertices = std::move(newVertices);
+    for (uint32_t &v : targetVertices)  v = newIds[v];
+    for (uint32_t &v : stationVertices) v = newIds[v];
+    
+    // Rebuild CSR arrays in new order. Neighbors are sorted by id (within
+    // the regular and the Boeg-only part) to access query buffers in order
+    std::vector<uint32_t> newOffsets(nVertices + 1);
+    std::vector<uint32_t> newRegularEnds(nVertices);
+    std::vector<uint32_t> newNbors(nEdges);
+    std::vector<uint8_t> newWeights(weights.size());
+    newOffsets[0] = 0;
+    uint32_t pos = 0;
+    // Neighbors (with their edge weights) of one part of a list
+    std::vector<std::pair<uint32_t,uint8_t>> part;
+    const auto appendSorted = [&](const uint32_t start, const uint32_t end)
+    {
+        part.clear();
+        for (uint32_t i = start; i < end; ++i) {
+            part.emplace_back(newIds[nbors[i]], static_cast<uint8_t>(edgeWeight(i)));
+        }
+        std::sort(part.begin(), part.end());
+        for (const auto &[n, weight] : part) {
+            if (!newWeights.empty()) newWeights[pos] = weight;
+            newNbors[pos++] = n;
+        }
+    };
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const uint32_t oldId = vertexOrder[v];
+        
+        appendSorted(offsets[oldId], regularEnds[oldId]);
+        newRegularEnds[v] = pos;
+        appendSorted(regularEnds[oldId], nborEnds[oldId]);
+        newOffsets[v + 1] = pos;
+    }
+    nborEnds.assign(newOffsets.begin() + 1, newOffsets.end());
+    offsets = std::move(newOffsets);
+    regularEnds = std::move(newRegularEnds);
+    nbors = std::move(newNbors);
+    weights = std::move(newWeights);
+    
+    // Compose with previous relabeling
+    if (order == ORDER_FILE) {
+        originalIds.clear();
+        internalIds.clear();
+    } else {
+        std::vector<uint32_t> newOriginalIds(nVertices);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            newOriginalIds[v] = getOriginalId(vertexOrder[v]);
+        }
+        originalIds = std::move(newOriginalIds);
+        internalIds.resize(nVertices);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            internalIds[originalIds[v]] = v;
+        }
+    }
+    
+    // Precomputed tables refer to old ids
+    stepParities = {computeStepParities(false), computeStepParities(true)};
+    buildBitMatrix();
+    const bool hadDistanceTables = hasDistanceTables();
+    const bool hadReachabilityIndex = hasReachabilityIndex();
+    const bool hadDistanceOracle = hasDistanceOracle();
+    distanceTables = {};
+    reachabilityIndexes = {};
+    distanceOracles = {};
+    if (hadDistanceTables) precomputeDistanceTables();
+    if (hadReachabilityIndex) precomputeReachabilityIndex();
+    if (hadDistanceOracle) precomputeDistanceOracle();
+}
+
+// Returns vertices in the order a BFS of every component (following edges
+// in their direction) visits them, i.e., order[newId] = current id. If
+// 'isReversed' is set, the reverse Cuthill-McKee order is computed instead:
+// each component is started from a pseudo-peripheral vertex, neighbors are
+// visited in order of increasing degree and the final order is reversed
+std::vector<uint32_t> Graph::computeBfsOrder(const bool isReversed) const
+{
+    std::vector<uint32_t> order;
+    order.reserve(nVertices);
+    std::vector<uint8_t> isOrdered(nVertices, 0);
+    
+    const auto degree = [this](const uint32_t v) { return nborEnds[v] - offsets[v]; };
+    
+    // Level structure of BFS from root restricted to not yet ordered
+    // vertices. Returns number of levels and start of last level
+    std::vector<uint32_t> levelOrder;
+    std::vector<uint32_t> levelStamps(nVertices, 0);
+    uint32_t stamp = 0;
+    const auto bfsLevels = [&](const uint32_t root, std::size_t &lastLevelStart)
+    {
+        ++stamp;
+        levelOrder.clear();
+        levelOrder.push_back(root);
+        levelStamps[root] = stamp;
+        
+        uint32_t nLevels = 1;
+        lastLevelStart = 0;
+        while (true) {
+            const std::size_t levelEnd = levelOrder.size();
+            for (std::size_t j = lastLevelStart; j < levelEnd; ++j) {
+                const uint32_t v = levelOrder[j];
+                for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+                    const uint32_t n = nbors[i];
+                    if (levelStamps[n] != stamp && !isOrdered[n]) {
+                        levelStamps[n] = stamp;
+                        levelOrder.push_back(n);
+                    }
+                }
+            }
+            if (levelOrder.size() == levelEnd) return nLevels;
+            
+            lastLevelStart = levelEnd;
+            ++nLevels;
+        }
+    };
+    
+    std::vector<uint32_t> sortedNbors;
+    // Note: On directed boards, the start vertex found for root need not
+    //       reach root, so root stays current until it is ordered
+    uint32_t root = 0;
+    while (root < nVertices) {
+        if (isOrdered[root]) {
+            ++root;
+            continue;
+        }
+        
+        uint32_t start = root;
+        if (isReversed) {
+            // Pseudo-peripheral start vertex (George & Liu, 1979): move to a
+            // vertex of minimum degree on the last BFS level as long as this
+            // increases the number of levels
+            std::size_t lastLevelStart;
+            uint32_t nLevels = bfsLevels(start, lastLevelStart);
+            for (uint32_t iteration = 0; iteration < maxPeripheralIterations; ++iteration) {
+                uint32_t candidate = levelOrder[lastLevelStart];
+                for (std::size_t j = lastLevelStart; j < levelOrder.size(); ++j) {
+                    if (degree(levelOrder[j]) < degree(candidate)) candidate = levelOrder[j];
+                }
+                
+                const uint32_t nCandidateLevels = bfsLevels(candidate, lastLevelStart);
+                if (nCandidateLevels <= nLevels) break;
+                
+                start = candidate;
+                nLevels = nCandidateLevels;
+            }
+        }
+        
+        // Cuthill-McKee (or plain BFS) numbering of this component
+        std::size_t head = order.size();
+        order.push_back(start);
+        isOrdered[start] = 1;
+        while (head < order.size()) {
+            const uint32_t v = order[head++];
+            
+            sortedNbors.clear();
+            for (uint32_t i = offsets[v]; i < nborEnds[v]; ++i) {
+                const uint32_t n = nbors[i];
+                if (!isOrdered[n]) {
+                    isOrdered[n] = 1;
+                    sortedNbors.push_back(n);
+                }
+            }
+            if (isReversed) {
+                std::stable_sort(sortedNbors.begin(), sortedNbors.end(),
+                    [&degree](const uint32_t a, const uint32_t b) { return degree(a) < degree(b); });
+            }
+            order.insert(order.end(), sortedNbors.begin(), sortedNbors.end());
+        }
+    }
+    
+    if (isReversed) {
+        std::reverse(order.begin(), order.end());
+    }
+    
+    return order;
+}
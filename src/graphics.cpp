@@ -50,10 +50,11 @@ GLFWwindow *Graphics::initGL()
 
 Graphics::Graphics() : 
     window(initGL()),
-    gameState("graphs/graph_fang.graphml", 4, 4),
-    circles(gameState.getVertices()), 
-    lines(gameState.getLinesFromEdges()), 
-    text("fonts/LiberationMono-Regular.ttf")
+    gameState(boardFile, 4, 4),
+    circles(gameState.getBoard().getVertices()), 
+    lines(Lines::fromEdges(gameState.getBoard())), 
+    text("fonts/LiberationMono-Regular.ttf"),
+    boardWatcher(boardFile)
 {
     // Initialize VAOs and associated VBOs, as well as shader program
     updateProjection(defaultWidth, defaultHeight);
@@ -70,6 +71,11 @@ void Graphics::run()
         // Update sound system
         sound.update();
         
+        if (boardWatcher.hasChanged())
+        {
+            reloadBoard();
+        }
+        
         GLint width, height;
         glfwGetFramebufferSize(window, &width, &height);
         // Compute current aspect ratio
@@ -122,7 +128,7 @@ void Graphics::run()
             vertexId = gameState.getBoegPosition();
             userColor = playerColors[nPlayableCharacters - 1];
         }
-        const auto &vertex = gameState.getVertices()[vertexId];
+        const auto &vertex = gameState.getBoard().getVertices()[vertexId];
         const std::wstring userPositionMsg(vertex.location.begin(), vertex.location.end());
         text.drawAt(userPositionMsg, -0.5f*width, -0.5f*height + 20.0f, userColor, aspect);
         
@@ -153,7 +159,7 @@ void Graphics::run()
         // Draw active targets of user
         for (const auto target : userPlayer.getActiveTargets())
         {
-            const auto &vertex = gameState.getVertices()[target];
+            const auto &vertex = gameState.getBoard().getVertices()[target];
             text.drawAtCentered(L"*", vertex.xpos*width*0.5f, vertex.ypos*height*0.5f, playerColors[userPlayer.getId()], Text::CENTER_BOTH, aspect);
         }
         
@@ -164,7 +170,7 @@ void Graphics::run()
             //       outline/border color for text
             const glm::vec3 color(64.0f / 255.0f, 54.0f / 255.0f, 43.0f / 255.0f);
             const uint32_t location = hoverLocationIndex.value();
-            const auto &vertex = gameState.getVertices()[location];
+            const auto &vertex = gameState.getBoard().getVertices()[location];
             const std::wstring locationMsg (vertex.location.begin(), vertex.location.end());
             text.drawAtCentered(locationMsg, vertex.xpos*width*0.5f, vertex.ypos*height*0.5f, color, Text::CENTER_BOTH, aspect, 0.5f);
         }
@@ -236,7 +242,7 @@ uint32_t Graphics::getClickedVertexByIndex() const
     const GLdouble radius = circles.radius;
     
     // Check all vertices for potential collision with mouse click position
-    const auto &vertices = gameState.getVertices();
+    const auto &vertices = gameState.getBoard().getVertices();
     for (uint32_t i = 0; i < vertices.size(); ++i)
     {
         const GLdouble dx = xpos - vertices[i].xpos;
@@ -251,6 +257,34 @@ uint32_t Graphics::getClickedVertexByIndex() const
     return std::numeric_limits<uint32_t>::max();  // no vertex was clicked
 }
 
+void Graphics::reloadBoard()
+{
+    try
+    {
+        // Note: The registry returns the current board if the contents did
+        //       not change (e.g., file only touched)
+        std::shared_ptr<const Graph> board = BoardRegistry::global().acquire(boardFile);
+        if (board.get() == &gameState.getBoard())
+        {
+            return;
+        }
+        
+        gameState.setBoard(std::move(board));
+    }
+    catch (const std::exception &e)
+    {
+        // E.g., file is still being written or has errors
+        std::cerr << "Failed to reload board: " << e.what() << '\n';
+        return;
+    }
+    
+    const Graph &board = gameState.getBoard();
+    circles.updateVertices(board.getVertices());
+    lines.updateLines(Lines::fromEdges(board));
+    hoverLocationIndex.reset();  // index may not exist anymore
+    sound.reset();  // as for a restart by key
+}
+
 Graphics::~Graphics()
 {
     // Free OpenGL resources
@@ -295,7 +329,7 @@ void Graphics::mouseButtonCallback(GLFWwindow *window, int button, int action, i
             if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
             {
                 const uint32_t vertexIndex = graphics->getClickedVertexByIndex();
-                if (vertexIndex < graphics->gameState.getNVertices())
+                if (vertexIndex < graphics->gameState.getBoard().getNVertices())
                 {
                     // Set clicked vertex (circle) index needed for user strategy
                     graphics->gameState.setUserClickedPosition(vertexIndex);
@@ -337,7 +371,7 @@ void Graphics::cursorPosCallback(GLFWwindow *window, double xpos, double ypos)
     if (graphics)
     {
         const uint32_t vertexIndex = graphics->getClickedVertexByIndex();
-        if (vertexIndex < graphics->gameState.getNVertices())
+        if (vertexIndex < graphics->gameState.getBoard().getNVertices())
         {
             graphics->hoverLocationIndex = vertexIndex;
         }
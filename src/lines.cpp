@@ -136,6 +136,32 @@ void Lines::updateProjection(const GLfloat width, const GLfloat height) const
     CHKERRGL(glUseProgram(0));
 }
 
+void Lines::updateLines(const std::vector<LineVertex> &lines)
+{
+    // Note: A buffer of the same size is overwritten in place, otherwise
+    //       reallocated (the VAO keeps referring to the same buffer)
+    const bool isSameSize = lines.size() == nLines;
+    nLines = lines.size();
+    
+    CHKERRGL(glBindBuffer(GL_ARRAY_BUFFER, vboLines));
+    if (isSameSize)
+    {
+        CHKERRGL(glBufferSubData(GL_ARRAY_BUFFER, 0,
+                                 lines.size() * sizeof(lines[0]),
+                                 lines.data()
+        ));
+    }
+    else
+    {
+        CHKERRGL(glBufferData(GL_ARRAY_BUFFER,
+                              lines.size() * sizeof(lines[0]),
+                              lines.data(),
+                              GL_STATIC_DRAW
+        ));
+    }
+    CHKERRGL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
 void Lines::draw() const
 {
     CHKERRGL(glUseProgram(shaderProgram));
@@ -174,5 +200,24 @@ Lines::~Lines()
     {
         std::cerr << "GL Error: " << e.what() << '\n';
     }
+}
+
+std::vector<LineVertex> Lines::fromEdges(const Graph &board)
+{
+    const std::vector<Vertex> &vertices = board.getVertices();
+    const std::vector<Edge> edges = board.getEdges();
+    
+    std::vector<LineVertex> lines;
+    lines.reserve(2 * edges.size());  // 2 Line vertices per edge
+    for (const Edge &edge : edges)
+    {
+        const auto &startVertex = vertices[edge.source];
+        const auto &endVertex = vertices[edge.target];
+        const glm::vec3 col = (edge.isBoegOnly) ? glm::vec3(0.9f, 0.9f, 0.9f)
+                                                : glm::vec3(0.0f, 0.0f, 0.0f);
+        lines.push_back({{startVertex.xpos, startVertex.ypos}, col});
+        lines.push_back({{endVertex.xpos, endVertex.ypos}, col});
+    }
     
+    return lines;
 }
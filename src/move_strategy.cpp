@@ -1,5 +1,69 @@
 #include <fangpp/move_strategy.hpp>
 
+namespace {
+
+// Whether target lies within 'diceRoll' steps of the start of 'startQuery'
+// Note: Distance 0 marks an unreachable target (on directed boards)
+bool isInReach(const GraphQuery &startQuery, const uint32_t target, const uint32_t diceRoll)
+{
+    const uint32_t distance = startQuery.minDistance(target);
+    
+    return distance != 0 && distance <= diceRoll;
+}
+
+// Move of 'diceRoll' steps along a shortest path towards destination,
+// which may end at destination early. On weighted boards, the shortest path
+// may end short with steps to spare; the move then ends at the move end
+// closest to destination instead (as it does if destination is unreachable)
+std::vector<uint32_t> moveTowards(const Graph &board, const GraphQuery &startQuery,
+    const uint32_t start, const uint32_t destination, const uint32_t diceRoll,
+    const bool isBoeg)
+{
+    // Note: Without a path to destination (on directed boards), the path
+    //       is destination alone
+    std::vector<uint32_t> path = startQuery.followMinPath(destination, diceRoll);
+    if (path.front() == start &&
+        (path.back() == destination || board.isCompleteMove(path, diceRoll, isBoeg)))
+    {
+        return path;
+    }
+    
+    std::vector<uint32_t> endpoints;
+    for (const uint32_t position : board.moveEndpoints(start, diceRoll, isBoeg)) {
+        endpoints.push_back(position);
+    }
+    if (endpoints.empty()) {
+        return std::vector<uint32_t>(1, start);  // no move at all, stay put
+    }
+    
+    const uint32_t destinations[] = {destination};
+    const auto distances = board.multiSourceDistances(endpoints, destinations, isBoeg);
+    // Note: Distance 0 marks an unreachable destination, except from itself
+    const auto distance = [&](const std::size_t i) {
+        return (endpoints[i] == destination || distances[i] != 0) ?
+            distances[i] : std::numeric_limits<uint32_t>::max();
+    };
+    std::size_t closest = 0;
+    for (std::size_t i = 1; i < endpoints.size(); ++i) {
+        if (distance(i) < distance(closest)) closest = i;
+    }
+    
+    return board.findMovePath(start, endpoints[closest], diceRoll, isBoeg);
+}
+
+}  // namespace
+
+std::unique_ptr<MoveStrategy> createStrategy(const StrategyType type)
+{
+    switch (type) {
+        case STRATEGY_USER:     return std::make_unique<UserStrategy>();
+        case STRATEGY_GREEDY:   return std::make_unique<GreedyStrategy>();
+        case STRATEGY_AVOIDANT: return std::make_unique<AvoidantStrategy>();
+    }
+    
+    throw std::invalid_argument("Unknown strategy type " + std::to_string(type));
+}
+
 std::vector<uint32_t> MoveStrategy::makeMove(Game &state, Player &player, 
     const uint32_t diceRoll) const
 {    
@@ -17,10 +81,9 @@ std::vector<uint32_t> GreedyStrategy::moveBoeg(Game &state, Player &player,
     const uint32_t start = state.getBoegPosition();
     const auto &targets = player.getActiveTargets();
     
-    GraphQuery &startQuery = player.getStartQuery();
-    GraphQuery &candidateQuery = player.getCandidateQuery();
+    ScopedQuery startQuery = state.getBoard().acquireQuery();
     // Compute shortest paths from start as Boeg
-    state.shortestPaths(start, startQuery, isBoeg);
+    state.getBoard().shortestPaths(start, *startQuery, isBoeg);
     
     // Note: Assumes maximum u32 value is never used
     const uint32_t unreachable = std::numeric_limits<uint32_t>::max();
@@ -28,68 +91,77 @@ std::vector<uint32_t> GreedyStrategy::moveBoeg(Game &state, Player &player,
     uint32_t bestTarget = unreachable;
     uint32_t minDistance = unreachable;
     uint32_t closestTarget = unreachable;
+    const std::vector<uint32_t> targetList(targets.begin(), targets.end());
+    std::vector<uint32_t> candidates;
     // Define function for updating current minimum of cost function
-    const auto minCostUpdate = [&state, &targets, &minCost, &bestTarget, &candidateQuery]
-        (const uint32_t candidate)
+    const auto minCostUpdate = [&state, &targetList, &minCost, &bestTarget]
+        (const std::vector<uint32_t> &positions)
     {
-        // Compute shortest paths starting from candidate position
-        state.shortestPaths(candidate, candidateQuery, isBoeg);
-        uint32_t cost = 0;
-        for (const uint32_t target : targets) {
-            // Note: Distance to self is simply 0 for candidate targets
-            cost += candidateQuery.minDistance(target);
-        }
-        // Pick reachable, unoccupied target that is closest to
-        // remaining targets
-        if (cost < minCost) {
-            minCost = cost;
-            bestTarget = candidate;
+        // Compute shortest paths starting from all candidate positions at once
+        const auto distances = state.getBoard().multiSourceDistances(positions, targetList, isBoeg);
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            uint32_t cost = 0;
+            for (std::size_t j = 0; j < targetList.size(); ++j) {
+                // Note: Distance to self is simply 0 for candidate targets
+                cost += distances[i * targetList.size() + j];
+            }
+            // Pick reachable, unoccupied target that is closest to
+            // remaining targets
+            if (cost < minCost) {
+                minCost = cost;
+                bestTarget = positions[i];
+            }
         }
     };
     
     // Search for unoccupied, reachable and closest targets
     for (const uint32_t target : targets) {
         // Keep track of closest target that is NOT already occupied by opponent
-        const uint32_t targetDistance = startQuery.minDistance(target);
-        if (targetDistance < minDistance) {
+        const uint32_t targetDistance = startQuery->minDistance(target);
+        if (targetDistance != 0 && targetDistance < minDistance) {
             minDistance = targetDistance;
             closestTarget = target;
         }
         // Check if this active target is reachable and NOT already occupied by opponent
-        if (diceRoll >= targetDistance && !state.isOpponentAtTarget(player, target)) {
-            minCostUpdate(target);
+        if (isInReach(*startQuery, target, diceRoll) && !state.isOpponentAtTarget(player, target)) {
+            candidates.push_back(target);
         }
     }
+    minCostUpdate(candidates);
     
     if (bestTarget != unreachable) {
         // Move to reachable, unoccupied target that is closest to the remaining targets
-        return startQuery.followMinPath(bestTarget, diceRoll);
+        return startQuery->followMinPath(bestTarget, diceRoll);
     }
     // From here on, unable to reach any unoccupied active target
     
     if (closestTarget != unreachable) {
         // Try following 'diceRoll' many steps along shortest path to closest target
-        const auto closest = startQuery.followMinPath(closestTarget, diceRoll);
-        if (!state.isOpponentAtTarget(player, closest.back())) {
+        // Note: On weighted boards, the path may end short with steps to spare
+        const auto closest = startQuery->followMinPath(closestTarget, diceRoll);
+        if (closest.size() > 1 && !state.isOpponentAtTarget(player, closest.back()) &&
+            state.getBoard().isCompleteMove(closest, diceRoll, isBoeg))
+        {
             return closest;
         }
-        // Already occupied by opponent, keep searching...
+        // Already occupied by opponent (or stuck), keep searching...
     }
     // Iterate over all reachable & unoccupied positions to find closest
     // to all active targets
     minCost = unreachable;
     bestTarget = unreachable;
-    const auto reachable = state.findAllReachableVertices(start, diceRoll, isBoeg);
-    for (const uint32_t position : reachable) {
+    candidates.clear();
+    for (const uint32_t position : state.getBoard().moveEndpoints(start, diceRoll, isBoeg)) {
         // Skip already occupied positions
         if (!state.isOpponentAtTarget(player, position)) { 
-            minCostUpdate(position);
+            candidates.push_back(position);
         }
     }
+    minCostUpdate(candidates);
     
     if (bestTarget != unreachable) {
         // Found suitable minimizer among reachable positions
-        return state.findPathOfLength(start, bestTarget, diceRoll, isBoeg);
+        return state.getBoard().findMovePath(start, bestTarget, diceRoll, isBoeg);
     }
     
     // No valid moves available. Simply stay put at start location
@@ -101,13 +173,14 @@ std::vector<uint32_t> GreedyStrategy::movePlayer(Game &state, Player &player,
 {
     const uint32_t start = player.getPosition();
     // Compute shortest paths from start as regular player
-    GraphQuery &startQuery = player.getStartQuery();
-    state.shortestPaths(start, startQuery);
+    ScopedQuery startQuery = state.getBoard().acquireQuery();
+    state.getBoard().shortestPaths(start, *startQuery);
     
     // Move 'diceRoll' many steps along shortest path to Boeg.
     // If Boeg is reachable within 'diceRoll' steps, end is simply the
     // position of the boeg
-    return startQuery.followMinPath(state.getBoegPosition(), diceRoll);
+    return moveTowards(state.getBoard(), *startQuery, start, state.getBoegPosition(),
+        diceRoll, false);
 }
 
 std::vector<uint32_t> AvoidantStrategy::moveBoeg(Game &state, Player &player,
@@ -117,87 +190,104 @@ std::vector<uint32_t> AvoidantStrategy::moveBoeg(Game &state, Player &player,
     const uint32_t start = state.getBoegPosition();
     const auto &targets = player.getActiveTargets();
     
-    GraphQuery &startQuery = player.getStartQuery();
-    GraphQuery &candidateQuery = player.getCandidateQuery();
+    ScopedQuery startQuery = state.getBoard().acquireQuery();
     // Compute shortest paths from start as Boeg
-    state.shortestPaths(start, startQuery, isBoeg);
+    state.getBoard().shortestPaths(start, *startQuery, isBoeg);
     
     // Reduce avoidance parameter based on fractional number of active targets.
     // This makes the player move more greedily if they are close to finishing
     // the game
     const double numActiveTargets = player.getActiveTargets().size();
     const double avoidance = m_AvoidanceBaseParam * (numActiveTargets / state.getNTargetsPlayer());
-        
+    
     // Note: Assumes maximum u32 value is never used
     const uint32_t unreachable = std::numeric_limits<uint32_t>::max();
     const double infinity = std::numeric_limits<double>::infinity();
     
     double minCost = infinity;
     uint32_t bestTarget = unreachable;
+    // Distances are needed to all active targets, followed by all opponents
+    std::vector<uint32_t> destinations(targets.begin(), targets.end());
+    const auto opponentPositions = state.getOpponentPositions(player);
+    destinations.insert(destinations.end(), opponentPositions.begin(), opponentPositions.end());
+    const std::size_t nTargets = targets.size();
+    std::vector<uint32_t> candidates;
     // Define function for updating current minimum of cost function
-    const auto minCostUpdate = [&state, &player, &targets, &minCost, &bestTarget, &candidateQuery, &avoidance]
-        (const uint32_t candidate)
+    const auto minCostUpdate = [&state, &destinations, nTargets, &minCost, &bestTarget, &avoidance]
+        (const std::vector<uint32_t> &positions)
     {
-        // Compute shortest paths starting from candidate position
-        state.shortestPaths(candidate, candidateQuery, isBoeg);
+        // Compute shortest paths starting from all candidate positions at once
+        const auto distances = state.getBoard().multiSourceDistances(positions, destinations, isBoeg);
         
-        double cost = 0.0;
-        for (const uint32_t target : targets) 
+        for (std::size_t i = 0; i < positions.size(); ++i)
         {
-            // Note: Distance to self is simply 0 for candidate targets
-            cost += static_cast<double>(candidateQuery.minDistance(target));
-        }
-        // Take into account shortest distance from opponents to candidate position.
-        // Larger distance from opponent means smaller cost
-        for (const uint32_t opponentPos : state.getOpponentPositions(player))
-        {
-            cost += avoidance / candidateQuery.minDistance(opponentPos);
-        }
-        // Pick reachable, unoccupied target that is closest to
-        // remaining targets
-        if (cost < minCost) 
-        {
-            minCost = cost;
-            bestTarget = candidate;
+            const uint32_t *candidateDistances = &distances[i * destinations.size()];
+            
+            double cost = 0.0;
+            for (std::size_t j = 0; j < nTargets; ++j) 
+            {
+                // Note: Distance to self is simply 0 for candidate targets
+                cost += static_cast<double>(candidateDistances[j]);
+            }
+            // Take into account shortest distance from opponents to candidate position.
+            // Larger distance from opponent means smaller cost
+            // Note: Distance 0 also marks an opponent out of reach (on
+            //       directed boards), which is no threat
+            for (std::size_t j = nTargets; j < destinations.size(); ++j)
+            {
+                if (candidateDistances[j] != 0 || destinations[j] == positions[i])
+                {
+                    cost += avoidance / candidateDistances[j];
+                }
+            }
+            // Pick reachable, unoccupied target that is closest to
+            // remaining targets. Any candidate beats none, even at infinite
+            // cost (next to an opponent), as the Boeg must move if it can
+            if (cost < minCost || bestTarget == unreachable) 
+            {
+                minCost = cost;
+                bestTarget = positions[i];
+            }
         }
     };
     
     // Search for unoccupied and reachable targets
     for (const uint32_t target : targets) 
     {
-        const uint32_t targetDistance = startQuery.minDistance(target);
         // Check if this active target is reachable and NOT already occupied by opponent
-        if (diceRoll >= targetDistance && !state.isOpponentAtTarget(player, target)) 
+        if (isInReach(*startQuery, target, diceRoll) && !state.isOpponentAtTarget(player, target)) 
         {
-            minCostUpdate(target);
+            candidates.push_back(target);
         }
     }
+    minCostUpdate(candidates);
     
     if (bestTarget != unreachable) 
     {
         // Move to reachable, unoccupied target that has the lowest 'cost'
-        return startQuery.followMinPath(bestTarget, diceRoll);
+        return startQuery->followMinPath(bestTarget, diceRoll);
     }
     // From here on, unable to reach any unoccupied active target.
     // Iterate over all reachable & unoccupied positions to find one
     // that minimizes the cost function
     minCost = infinity;
     bestTarget = unreachable;
+    candidates.clear();
     
-    const auto reachable = state.findAllReachableVertices(start, diceRoll, isBoeg);
-    for (const uint32_t position : reachable) 
+    for (const uint32_t position : state.getBoard().moveEndpoints(start, diceRoll, isBoeg)) 
     {
         // Skip already occupied positions
         if (!state.isOpponentAtTarget(player, position)) 
         { 
-            minCostUpdate(position);
+            candidates.push_back(position);
         }
     }
+    minCostUpdate(candidates);
     
     if (bestTarget != unreachable) 
     {
         // Found suitable minimizer among reachable positions
-        return state.findPathOfLength(start, bestTarget, diceRoll, isBoeg);
+        return state.getBoard().findMovePath(start, bestTarget, diceRoll, isBoeg);
     }
     
     // No valid moves available. Simply stay put at start location
@@ -209,13 +299,14 @@ std::vector<uint32_t> AvoidantStrategy::movePlayer(Game &state, Player &player,
 {
     const uint32_t start = player.getPosition();
     // Compute shortest paths from start as regular player
-    GraphQuery &startQuery = player.getStartQuery();
-    state.shortestPaths(start, startQuery);
+    ScopedQuery startQuery = state.getBoard().acquireQuery();
+    state.getBoard().shortestPaths(start, *startQuery);
     
     // Move 'diceRoll' many steps along shortest path to Boeg.
     // If Boeg is reachable within 'diceRoll' steps, end is simply the
     // position of the boeg
-    return startQuery.followMinPath(state.getBoegPosition(), diceRoll);
+    return moveTowards(state.getBoard(), *startQuery, start, state.getBoegPosition(),
+        diceRoll, false);
 }
 
 std::vector<uint32_t> UserStrategy::moveBoeg(Game &state, Player &player,
@@ -225,10 +316,9 @@ std::vector<uint32_t> UserStrategy::moveBoeg(Game &state, Player &player,
     
     // Verify that user has at least 1 valid move 
     bool hasReachablePosition = false;
-    // Need to first verify if user has any valid moves using exactly
-    // diceRoll many steps
-    const auto reachable = state.findAllReachableVertices(start, diceRoll, true);
-    for (const uint32_t position : reachable) 
+    // Need to first verify if user has any valid moves using up diceRoll
+    // (see Graph::moveEndpoints()). Enumeration stops at the first valid position
+    for (const uint32_t position : state.getBoard().moveEndpoints(start, diceRoll, true)) 
     {
         // Skip already occupied positions
         if (!state.isOpponentAtTarget(player, position)) 
@@ -239,8 +329,8 @@ std::vector<uint32_t> UserStrategy::moveBoeg(Game &state, Player &player,
     }
     
     // Compute shortest paths from boeg position
-    GraphQuery &startQuery = player.getStartQuery();
-    state.shortestPaths(start, startQuery, true);
+    ScopedQuery startQuery = state.getBoard().acquireQuery();
+    state.getBoard().shortestPaths(start, *startQuery, true);
     
     if (!hasReachablePosition)
     {
@@ -248,8 +338,7 @@ std::vector<uint32_t> UserStrategy::moveBoeg(Game &state, Player &player,
         // using < diceRoll many steps
         for (const uint32_t target : player.getActiveTargets())
         {
-            const uint32_t targetDistance = startQuery.minDistance(target);
-            if (diceRoll >= targetDistance && !state.isOpponentAtTarget(player, target))
+            if (isInReach(*startQuery, target, diceRoll) && !state.isOpponentAtTarget(player, target))
             {
                 hasReachablePosition = true;
                 break;
@@ -273,9 +362,9 @@ std::vector<uint32_t> UserStrategy::moveBoeg(Game &state, Player &player,
     {
         if (m_userClickedPosition == target)
         {
-            if (diceRoll >= startQuery.minDistance(m_userClickedPosition))
+            if (isInReach(*startQuery, m_userClickedPosition, diceRoll))
             {
-                return startQuery.followMinPath(m_userClickedPosition, diceRoll);
+                return startQuery->followMinPath(m_userClickedPosition, diceRoll);
             }
             else
             {
@@ -285,7 +374,7 @@ std::vector<uint32_t> UserStrategy::moveBoeg(Game &state, Player &player,
     }
     
     // Return a valid simple path ending at clicked position if one exists
-    return state.findPathOfLength(start, m_userClickedPosition, diceRoll, true);
+    return state.getBoard().findMovePath(start, m_userClickedPosition, diceRoll, true);
 }
 
 std::vector<uint32_t> UserStrategy::movePlayer(Game &state, Player &player,
@@ -296,12 +385,12 @@ std::vector<uint32_t> UserStrategy::movePlayer(Game &state, Player &player,
     if (m_userClickedPosition == state.getBoegPosition())
     {
         // Compute shortest paths from start as regular player
-        GraphQuery &startQuery = player.getStartQuery();
-        state.shortestPaths(player.getPosition(), startQuery);
+        ScopedQuery startQuery = state.getBoard().acquireQuery();
+        state.getBoard().shortestPaths(player.getPosition(), *startQuery);
         
-        if (diceRoll >= startQuery.minDistance(m_userClickedPosition))
+        if (isInReach(*startQuery, m_userClickedPosition, diceRoll))
         {
-            return startQuery.followMinPath(m_userClickedPosition, diceRoll);
+            return startQuery->followMinPath(m_userClickedPosition, diceRoll);
         }
         else
         {
@@ -311,6 +400,6 @@ std::vector<uint32_t> UserStrategy::movePlayer(Game &state, Player &player,
     else
     {
         // Return a valid simple path ending at clicked position if one exists
-        return state.findPathOfLength(player.getPosition(), m_userClickedPosition, diceRoll, false);        
+        return state.getBoard().findMovePath(player.getPosition(), m_userClickedPosition, diceRoll, false);
     }
 }
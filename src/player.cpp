@@ -22,8 +22,26 @@ void Player::setPlayerClickedPosition(const uint32_t pos)
     moveStrategy->setUserClickedPosition(pos);
 }
 
-Player::~Player()
+uint32_t Player::getActiveTargetMask() const
 {
-    // Cleanup owned moveStrategy
-    delete moveStrategy;
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < targets.size(); ++i) {
+        if (isActiveTarget(targets[i])) mask |= (1u << i);
+    }
+    
+    return mask;
+}
+
+void Player::setActiveTargetMask(const uint32_t mask)
+{
+    assert(targets.size() >= 32 || (mask >> targets.size()) == 0);
+    
+    // Note: Keeps the capacity, so that restoring states does not allocate
+    activeTargets.clear();
+    for (uint32_t i = 0; i < targets.size(); ++i) {
+        if (mask & (1u << i)) activeTargets.push_back(targets[i]);
+    }
 }
+
+// Note: Defined here, as strategies are incomplete where Player is declared
+Player::~Player() = default;
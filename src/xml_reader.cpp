@@ -0,0 +1,205 @@
+#include <fangpp/xml_reader.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+static bool isWhitespace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+XmlReader::Event XmlReader::next()
+{
+    if (isEndPending) {
+        // Closing event of self-closing element (name is unchanged)
+        isEndPending = false;
+        return END_ELEMENT;
+    }
+    
+    while (cur < end) {
+        if (*cur != '<') {
+            // Character data up to next markup
+            const char *start = cur;
+            cur = std::find(cur, end, '<');
+            text = std::string_view(start, cur - start);
+            isTextRaw = false;
+            return TEXT;
+        }
+        
+        if (startsWith("<!--")) {
+            skipPast("-->");
+        } else if (startsWith("<![CDATA[")) {
+            cur += 9;
+            const char *start = cur;
+            skipPast("]]>");
+            text = std::string_view(start, cur - 3 - start);
+            isTextRaw = true;
+            return TEXT;
+        } else if (startsWith("<?")) {
+            skipPast("?>");
+        } else if (startsWith("<!")) {
+            // Note: DOCTYPE declarations with internal subsets are not supported
+            skipPast(">");
+        } else if (startsWith("</")) {
+            cur += 2;
+            name = parseName();
+            skipWhitespace();
+            if (cur == end || *cur != '>') error("Expected '>' after end tag");
+            if (openElements.empty() || openElements.back() != name) {
+                error("Mismatched end tag '" + std::string(name) + "'");
+            }
+            openElements.pop_back();
+            ++cur;
+            return END_ELEMENT;
+        } else {
+            return parseStartElement();
+        }
+    }
+    
+    if (!openElements.empty()) {
+        error("Unclosed element '" + std::string(openElements.back()) + "'");
+    }
+    
+    return END_OF_DOCUMENT;
+}
+
+XmlReader::Event XmlReader::parseStartElement()
+{
+    ++cur;  // skip '<'
+    name = parseName();
+    attributes.clear();
+    
+    while (true) {
+        skipWhitespace();
+        if (cur == end) error("Unterminated start tag");
+        
+        if (*cur == '>') {
+            ++cur;
+            openElements.push_back(name);
+            return START_ELEMENT;
+        }
+        if (*cur == '/') {
+            ++cur;
+            if (cur == end || *cur != '>') error("Expected '>' after '/'");
+            ++cur;
+            isEndPending = true;
+            return START_ELEMENT;
+        }
+        
+        // Attribute: name = "value" (or 'value')
+        const std::string_view attrName = parseName();
+        skipWhitespace();
+        if (cur == end || *cur != '=') error("Expected '=' after attribute name");
+        ++cur;
+        skipWhitespace();
+        if (cur == end || (*cur != '"' && *cur != '\'')) error("Expected quoted attribute value");
+        
+        const char quote = *cur++;
+        const char *start = cur;
+        cur = std::find(cur, end, quote);
+        if (cur == end) error("Unterminated attribute value");
+        attributes.push_back({attrName, std::string_view(start, cur - start)});
+        ++cur;  // skip closing quote
+    }
+}
+
+std::optional<std::string_view> XmlReader::getAttribute(std::string_view attrName) const
+{
+    for (const Attribute &attr : attributes) {
+        if (attr.name == attrName) return attr.value;
+    }
+    
+    return std::nullopt;
+}
+
+void XmlReader::appendText(std::string &out) const
+{
+    if (isTextRaw) {
+        out.append(text);
+    } else {
+        appendDecoded(text, out);
+    }
+}
+
+void XmlReader::appendDecoded(std::string_view raw, std::string &out) const
+{
+    while (!raw.empty()) {
+        const std::size_t amp = raw.find('&');
+        out.append(raw.substr(0, amp));
+        if (amp == std::string_view::npos) break;
+        
+        const std::size_t semicolon = raw.find(';', amp);
+        if (semicolon == std::string_view::npos) error("Unterminated entity reference");
+        const std::string_view entity = raw.substr(amp + 1, semicolon - amp - 1);
+        
+        if (entity == "lt") out += '<';
+        else if (entity == "gt") out += '>';
+        else if (entity == "amp") out += '&';
+        else if (entity == "quot") out += '"';
+        else if (entity == "apos") out += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            // Numeric character reference, encoded as UTF-8
+            const bool isHex = entity[1] == 'x';
+            uint32_t code = 0;
+            for (const char c : entity.substr(isHex ? 2 : 1)) {
+                uint32_t digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (isHex && c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (isHex && c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else error("Invalid character reference");
+                code = code * (isHex ? 16 : 10) + digit;
+                if (code > 0x10FFFF) error("Invalid character reference");
+            }
+            
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        } else {
+            error("Unknown entity '" + std::string(entity) + "'");
+        }
+        
+        raw.remove_prefix(semicolon + 1);
+    }
+}
+
+void XmlReader::error(const std::string &message) const
+{
+    const auto line = std::count(begin, std::min(cur, end), '\n') + 1;
+    throw std::runtime_error("Parse error in line " + std::to_string(line) + ": " + message);
+}
+
+void XmlReader::skipPast(std::string_view terminator)
+{
+    const char *pos = std::search(cur, end, terminator.begin(), terminator.end());
+    if (pos == end) error("Expected '" + std::string(terminator) + "'");
+    
+    cur = pos + terminator.size();
+}
+
+void XmlReader::skipWhitespace()
+{
+    while (cur < end && isWhitespace(*cur)) ++cur;
+}
+
+std::string_view XmlReader::parseName()
+{
+    const char *start = cur;
+    while (cur < end && !isWhitespace(*cur) && *cur != '>' && *cur != '/' && *cur != '=') {
+        ++cur;
+    }
+    if (cur == start) error("Expected name");
+    
+    return std::string_view(start, cur - start);
+}
@@ -0,0 +1,197 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <exception>
+#include <chrono>
+#include <cmath>
+
+#include <fangpp/graph.hpp>
+
+// Reports how a board plays: betweenness centrality, eccentricities and
+// how far stations are from each target, for players and for the Boeg.
+// Optionally writes per-vertex features (e.g., for move heuristics) to a
+// CSV file
+
+namespace {
+
+struct ReportOptions {
+    AnalyticsOptions analytics;
+    uint32_t nTopVertices = 10;  // most central vertices listed
+    std::string csvFile;         // per-vertex features (none if empty)
+};
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options] <board>\n"
+              << "  -j <threads>  number of threads (default: all hardware threads)\n"
+              << "  -n <samples>  estimate betweenness from <samples> sources (default: all)\n"
+              << "  -s <seed>     random seed of sampled sources (default 1)\n"
+              << "  -t <count>    number of most central vertices listed (default 10)\n"
+              << "  -o <file>     write per-vertex features as CSV\n";
+}
+
+ReportOptions parseOptions(const int argc, char *argv[], const char *&boardFile)
+{
+    ReportOptions options;
+    boardFile = nullptr;
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string
+        {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value of option " + arg);
+            return argv[++i];
+        };
+        
+        if (arg == "-j") {
+            options.analytics.nThreads = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-n") {
+            options.analytics.nSamples = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-s") {
+            options.analytics.seed = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-t") {
+            options.nTopVertices = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-o") {
+            options.csvFile = value();
+        } else if (!boardFile && arg[0] != '-') {
+            boardFile = argv[i];
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    
+    if (!boardFile) throw std::invalid_argument("Missing board file");
+    
+    return options;
+}
+
+std::string describeVertex(const Graph &graph, const uint32_t v)
+{
+    const std::string &location = graph.getVertices()[v].location;
+    const std::string id = std::to_string(graph.getOriginalId(v));
+    
+    return (location.empty() || location == id) ? id : id + " (" + location + ")";
+}
+
+void printReport(const Graph &graph, const BoardAnalytics &analytics,
+    const ReportOptions &options)
+{
+    const uint32_t nVertices = graph.getNVertices();
+    double meanEccentricity = 0.0;
+    for (const uint32_t eccentricity : analytics.eccentricities) {
+        meanEccentricity += eccentricity;
+    }
+    meanEccentricity /= std::max(1u, nVertices);
+    std::cout << "Diameter " << analytics.diameter << ", radius " << analytics.radius
+              << ", mean eccentricity " << std::fixed << std::setprecision(2)
+              << meanEccentricity << '\n';
+    
+    std::vector<uint32_t> order(nVertices);
+    std::iota(order.begin(), order.end(), 0);
+    const uint32_t nTop = std::min(options.nTopVertices, nVertices);
+    std::partial_sort(order.begin(), order.begin() + nTop, order.end(),
+        [&analytics](const uint32_t a, const uint32_t b) {
+            return analytics.betweenness[a] > analytics.betweenness[b];
+        });
+    std::cout << "Most central vertices (betweenness"
+              << ((options.analytics.nSamples > 0) ? ", estimated" : "") << "):\n";
+    for (uint32_t i = 0; i < nTop; ++i) {
+        std::cout << "  " << std::setw(14) << std::setprecision(1) << analytics.betweenness[order[i]]
+                  << "  " << describeVertex(graph, order[i]) << '\n';
+    }
+    
+    // Balance: targets far from most stations are rarely drawn to good effect
+    const std::vector<uint32_t> &targets = graph.getTargetVertices();
+    if (targets.empty()) return;
+    std::cout << "Distance from stations to targets (mean, median, max, unreachable):\n";
+    std::vector<double> means;
+    for (std::size_t j = 0; j < targets.size(); ++j) {
+        const std::vector<uint32_t> &counts = analytics.targetDistanceCounts[j];
+        uint64_t nReachable = 0, sum = 0;
+        for (std::size_t d = 0; d < counts.size(); ++d) {
+            nReachable += counts[d];
+            sum += d * counts[d];
+        }
+        uint32_t median = 0;
+        for (uint64_t seen = 0; median < counts.size(); ++median) {
+            seen += counts[median];
+            if (2 * seen >= nReachable) break;
+        }
+        
+        const double mean = (nReachable > 0) ? static_cast<double>(sum) / nReachable : 0.0;
+        if (nReachable > 0) means.push_back(mean);
+        std::cout << "  " << std::setw(8) << std::setprecision(2) << mean
+                  << std::setw(6) << median
+                  << std::setw(6) << ((counts.empty()) ? 0 : counts.size() - 1)
+                  << std::setw(8) << analytics.unreachableStations[j]
+                  << "  " << describeVertex(graph, targets[j]) << '\n';
+    }
+    if (means.empty()) return;
+    
+    double meanOfMeans = 0.0, variance = 0.0;
+    for (const double mean : means) meanOfMeans += mean;
+    meanOfMeans /= means.size();
+    for (const double mean : means) variance += (mean - meanOfMeans) * (mean - meanOfMeans);
+    variance /= means.size();
+    const auto [closest, farthest] = std::minmax_element(means.begin(), means.end());
+    std::cout << "Target balance: mean distances range from " << *closest << " to "
+              << *farthest << " (standard deviation " << std::sqrt(variance) << ")\n";
+}
+
+void writeFeatures(const std::string &csvFile, const Graph &graph,
+    const std::array<BoardAnalytics, 2> &analytics)
+{
+    std::ofstream file(csvFile);
+    if (!file) throw std::runtime_error("Failed to open " + csvFile);
+    
+    file << "id,location,betweenness,eccentricity,boeg_betweenness,boeg_eccentricity\n";
+    for (uint32_t v = 0; v < graph.getNVertices(); ++v) {
+        file << graph.getOriginalId(v) << ',' << graph.getVertices()[v].location;
+        for (const BoardAnalytics &role : analytics) {
+            file << ',' << role.betweenness[v] << ',' << role.eccentricities[v];
+        }
+        file << '\n';
+    }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    try {
+        const char *boardFile;
+        const ReportOptions options = parseOptions(argc, argv, boardFile);
+        
+        const Graph graph(boardFile);
+        std::cout << boardFile << ": " << graph.getNVertices() << " vertices, "
+                  << graph.getNEdges() << " edges ("
+                  << ((graph.getGraphType() == Graph::GRAPH_DIRECTED) ? "directed" : "undirected")
+                  << ((graph.isWeighted()) ? ", weighted" : "") << ")\n";
+        
+        std::array<BoardAnalytics, 2> analytics;
+        for (const bool isBoeg : {false, true}) {
+            const auto start = std::chrono::steady_clock::now();
+            analytics[isBoeg] = graph.computeAnalytics(isBoeg, options.analytics);
+            const auto end = std::chrono::steady_clock::now();
+            
+            std::cout << '\n' << ((isBoeg) ? "Boeg" : "Players") << " (computed in "
+                      << std::fixed << std::setprecision(3) << std::chrono::duration<double>(end - start).count()
+                      << " s)\n";
+            printReport(graph, analytics[isBoeg], options);
+        }
+        
+        if (!options.csvFile.empty()) {
+            writeFeatures(options.csvFile, graph, analytics);
+            std::cout << "\nFeatures written to " << options.csvFile << '\n';
+        }
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << '\n';
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
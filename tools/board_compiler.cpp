@@ -0,0 +1,28 @@
+#include <iostream>
+#include <exception>
+
+#include <fangpp/graph.hpp>
+
+// Compile a board file (e.g. GraphML) into the binary board format, which
+// is loaded without any parsing
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input board> <output .fbrd>\n";
+        return EXIT_FAILURE;
+    }
+    
+    try {
+        const Graph graph(argv[1]);
+        graph.writeBinary(argv[2]);
+        
+        std::cout << "Compiled " << argv[1] << " (" << graph.getNVertices()
+                  << " vertices, " << graph.getNEdges() << " edges) to "
+                  << argv[2] << '\n';
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
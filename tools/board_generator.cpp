@@ -0,0 +1,381 @@
+#include <iostream>
+#include <exception>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include <fangpp/graph.hpp>
+
+// Generates near-planar boards of arbitrary size for scaling tests. Vertices
+// are jittered grid points (one per grid cell). Each vertex draws a desired
+// degree from the chosen distribution, then candidate edges to nearby grid
+// cells are added shortest first as long as both ends still have degree
+// left. Crossing diagonals within a grid square are never both added.
+// Finally, the shortest candidate edges joining different components are
+// added until the board is connected. Degrees are drawn again with a
+// corrected mean until the board has the requested mean degree. Boeg-only
+// edges are never needed to connect the board for players
+
+namespace {
+
+enum DegreeDistribution {
+    DEGREE_FIXED = 0,  // every vertex has (about) the mean degree
+    DEGREE_POISSON,    // 1 + Poisson(mean - 1)
+    DEGREE_POWERLAW    // heavy-tailed (discrete Pareto, exponent 2.5)
+};
+
+struct GeneratorOptions {
+    uint32_t nVertices = 10000;
+    double meanDegree = 3.0;
+    DegreeDistribution distribution = DEGREE_POISSON;
+    double targetFraction = 0.3;  // similar to the original board
+    double boegFraction = 0.1;    // share of Boeg-only edges
+    uint32_t seed = 1;
+    bool isShuffled = false;      // randomize vertex ids
+};
+
+// Rounds of correcting the mean degrees are drawn with, and relative
+// deviation of the realized mean degree from the requested one accepted
+constexpr const uint32_t maxCalibrationRounds = 8;
+constexpr const double degreeTolerance = 0.01;
+
+struct CandidateEdge {
+    float length2;  // squared length
+    uint32_t u;
+    uint32_t v;
+};
+
+// Union-find over vertices (path halving)
+class Components {
+public:
+    explicit Components(const uint32_t n) : parents(n)
+    {
+        std::iota(parents.begin(), parents.end(), 0);
+    }
+    
+    uint32_t find(uint32_t v)
+    {
+        while (parents[v] != v) {
+            parents[v] = parents[parents[v]];
+            v = parents[v];
+        }
+        
+        return v;
+    }
+    
+    // Returns false if u and v were connected already
+    bool unite(const uint32_t u, const uint32_t v)
+    {
+        const uint32_t ru = find(u), rv = find(v);
+        if (ru == rv) return false;
+        parents[ru] = rv;
+        
+        return true;
+    }
+
+private:
+    std::vector<uint32_t> parents;
+};
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options] <output (.graphml, .txt or .fbrd)>\n"
+              << "  -n <vertices>      number of vertices (default 10000)\n"
+              << "  -d <degree>        mean vertex degree, at least 1 (default 3)\n"
+              << "  -D <distribution>  degree distribution: fixed, poisson or powerlaw\n"
+              << "                     (default poisson)\n"
+              << "  -t <fraction>      fraction of target vertices (default 0.3)\n"
+              << "  -b <fraction>      share of Boeg-only edges (default 0.1)\n"
+              << "  -s <seed>          random seed (default 1)\n"
+              << "  -r                 randomize vertex ids\n";
+}
+
+GeneratorOptions parseOptions(const int argc, char *argv[], const char *&outputFile)
+{
+    GeneratorOptions options;
+    outputFile = nullptr;
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string
+        {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value of option " + arg);
+            return argv[++i];
+        };
+        
+        if (arg == "-n") {
+            options.nVertices = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-d") {
+            options.meanDegree = std::stod(value());
+        } else if (arg == "-D") {
+            const std::string name = value();
+            if (name == "fixed") {
+                options.distribution = DEGREE_FIXED;
+            } else if (name == "poisson") {
+                options.distribution = DEGREE_POISSON;
+            } else if (name == "powerlaw") {
+                options.distribution = DEGREE_POWERLAW;
+            } else {
+                throw std::invalid_argument("Unknown degree distribution: " + name);
+            }
+        } else if (arg == "-t") {
+            options.targetFraction = std::stod(value());
+        } else if (arg == "-b") {
+            options.boegFraction = std::stod(value());
+        } else if (arg == "-s") {
+            options.seed = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-r") {
+            options.isShuffled = true;
+        } else if (!outputFile && arg[0] != '-') {
+            outputFile = argv[i];
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    
+    if (!outputFile) throw std::invalid_argument("Missing output file");
+    if (options.nVertices < 2) throw std::invalid_argument("Need at least 2 vertices");
+    if (options.meanDegree < 1.0) throw std::invalid_argument("Mean degree must be at least 1");
+    if (options.targetFraction < 0.0 || options.targetFraction > 1.0 ||
+        options.boegFraction < 0.0 || options.boegFraction > 1.0)
+    {
+        throw std::invalid_argument("Fractions must lie in [0, 1]");
+    }
+    
+    return options;
+}
+
+// Desired degree of a vertex drawn with mean 'meanDegree'
+uint32_t sampleDegree(const DegreeDistribution distribution, const double meanDegree,
+    std::mt19937 &prng)
+{
+    switch (distribution) {
+        case DEGREE_FIXED: {
+            // Round randomly to hit the (fractional) mean on average
+            const double floorDegree = std::floor(meanDegree);
+            std::bernoulli_distribution roundUp(meanDegree - floorDegree);
+            return static_cast<uint32_t>(floorDegree) + roundUp(prng);
+        }
+        case DEGREE_POISSON: {
+            std::poisson_distribution<uint32_t> extra(meanDegree - 1.0);
+            return 1 + extra(prng);
+        }
+        case DEGREE_POWERLAW: {
+            // Pareto with exponent 2.5 has mean 3 * minimum
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            const double minDegree = meanDegree / 3.0;
+            const double degree = minDegree * std::pow(1.0 - uniform(prng), -1.0 / 1.5);
+            return std::max(1u, static_cast<uint32_t>(std::lround(degree)));
+        }
+    }
+    
+    return 1;
+}
+
+Graph generateBoard(const GeneratorOptions &options)
+{
+    std::mt19937 prng(options.seed);
+    const uint32_t nVertices = options.nVertices;
+    
+    // Grid of width x height cells, last row possibly incomplete
+    const uint32_t width = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(nVertices))));
+    const uint32_t height = (nVertices + width - 1) / width;
+    const float scale = 1.9f / std::max(width, height);  // fit into [-0.95, 0.95]
+    
+    std::uniform_real_distribution<float> jitter(-0.4f, 0.4f);
+    std::vector<Vertex> vertices(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        Vertex &vert = vertices[v];
+        vert.location = std::to_string(v);
+        vert.xpos = -0.95f + scale * (v % width + 0.5f + jitter(prng));
+        vert.ypos =  0.95f - scale * (v / width + 0.5f + jitter(prng));
+        vert.isTarget = 0;
+    }
+    
+    // Candidate edges to cells within 'radius' (each pair once)
+    const int radius = (options.meanDegree > 4.0 || options.distribution == DEGREE_POWERLAW) ? 2 : 1;
+    const uint32_t maxDegree = (2 * radius + 1) * (2 * radius + 1) - 1;
+    std::vector<CandidateEdge> candidates;
+    candidates.reserve(static_cast<std::size_t>(nVertices) * maxDegree / 2);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const int x = v % width, y = v / width;
+        for (int dy = 0; dy <= radius; ++dy) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+                if (dy == 0 && dx <= 0) continue;  // pair is generated from other end
+                
+                const int nx = x + dx, ny = y + dy;
+                if (nx < 0 || nx >= static_cast<int>(width)) continue;
+                const uint32_t n = ny * width + nx;
+                if (n >= nVertices) continue;
+                
+                const float ex = vertices[n].xpos - vertices[v].xpos;
+                const float ey = vertices[n].ypos - vertices[v].ypos;
+                candidates.push_back({ex * ex + ey * ey, v, n});
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const CandidateEdge &a, const CandidateEdge &b) { return a.length2 < b.length2; });
+    
+    std::vector<uint32_t> remainingDegree(nVertices);
+    // Diagonals added per grid square (bit 0: '\', bit 1: '/')
+    std::vector<uint8_t> diagonals(static_cast<std::size_t>(width) * height, 0);
+    const auto isCrossing = [&](const CandidateEdge &edge, const bool isAdding)
+    {
+        const int ux = edge.u % width, uy = edge.u / width;
+        const int vx = edge.v % width, vy = edge.v / width;
+        if (std::abs(ux - vx) != 1 || std::abs(uy - vy) != 1) return false;
+        
+        // Note: v is always in the row below u
+        const uint32_t square = uy * width + std::min(ux, vx);
+        const uint8_t bit = (vx > ux) ? 1 : 2;
+        if (diagonals[square] & (3 - bit)) return true;
+        if (isAdding) diagonals[square] |= bit;
+        
+        return false;
+    };
+    
+    std::vector<uint32_t> edgeSources, edgeTargets;
+    std::vector<uint8_t> edgeBoegFlags;
+    std::vector<uint8_t> isAdded(candidates.size());
+    // Add edges for degrees drawn with mean 'sampleMean'
+    const auto addEdges = [&](const double sampleMean)
+    {
+        for (uint32_t &degree : remainingDegree) {
+            degree = std::min(sampleDegree(options.distribution, sampleMean, prng), maxDegree);
+        }
+        std::fill(diagonals.begin(), diagonals.end(), 0);
+        std::fill(isAdded.begin(), isAdded.end(), 0);
+        edgeSources.clear();
+        edgeTargets.clear();
+        
+        Components components(nVertices);
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            const CandidateEdge &edge = candidates[i];
+            if (remainingDegree[edge.u] == 0 || remainingDegree[edge.v] == 0) continue;
+            if (isCrossing(edge, true)) continue;
+            
+            --remainingDegree[edge.u];
+            --remainingDegree[edge.v];
+            components.unite(edge.u, edge.v);
+            edgeSources.push_back(edge.u);
+            edgeTargets.push_back(edge.v);
+            isAdded[i] = 1;
+        }
+        
+        // Connect components (Kruskal on remaining candidates)
+        // Note: Candidates include all horizontal/vertical grid neighbors, so
+        //       the result is always connected
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            const CandidateEdge &edge = candidates[i];
+            if (isAdded[i] || components.find(edge.u) == components.find(edge.v)) continue;
+            if (isCrossing(edge, true)) continue;
+            
+            components.unite(edge.u, edge.v);
+            edgeSources.push_back(edge.u);
+            edgeTargets.push_back(edge.v);
+        }
+    };
+    
+    // Not all drawn degrees are realized: neighbors run out of degree,
+    // diagonals would cross and heavy-tailed degrees exceed the candidates.
+    // Hence the mean degrees are drawn with is corrected until the board
+    // has the requested mean degree. Every round draws from the same state
+    const std::mt19937 degreePrng = prng;
+    double sampleMean = options.meanDegree;
+    double meanDegree = 0.0;
+    for (uint32_t round = 0; round < maxCalibrationRounds; ++round) {
+        prng = degreePrng;
+        addEdges(sampleMean);
+        meanDegree = 2.0 * edgeSources.size() / nVertices;
+        if (std::abs(meanDegree - options.meanDegree) <= degreeTolerance * options.meanDegree) break;
+        sampleMean = std::max(1.0, sampleMean * options.meanDegree / meanDegree);
+    }
+    if (std::abs(meanDegree - options.meanDegree) > degreeTolerance * options.meanDegree) {
+        std::cerr << "Warning: Mean degree " << options.meanDegree << " is out of reach, "
+                  << "board has mean degree " << meanDegree << '\n';
+    }
+    
+    // Boeg-only edges: a random spanning tree stays regular, so players
+    // can reach every vertex. The other edges are Boeg-only with the
+    // probability that yields the requested share (as far as they suffice)
+    const std::size_t nEdges = edgeSources.size();
+    std::vector<uint32_t> edgeOrder(nEdges);
+    std::iota(edgeOrder.begin(), edgeOrder.end(), 0);
+    std::shuffle(edgeOrder.begin(), edgeOrder.end(), prng);
+    Components regularComponents(nVertices);
+    std::vector<uint32_t> nonTreeEdges;
+    for (const uint32_t e : edgeOrder) {
+        if (!regularComponents.unite(edgeSources[e], edgeTargets[e])) nonTreeEdges.push_back(e);
+    }
+    const double boegOnlyProbability = (nonTreeEdges.empty()) ? 0.0 :
+        std::min(1.0, options.boegFraction * nEdges / nonTreeEdges.size());
+    if (options.boegFraction * nEdges > nonTreeEdges.size()) {
+        std::cerr << "Warning: Share of Boeg-only edges " << options.boegFraction
+                  << " is out of reach, board has share "
+                  << static_cast<double>(nonTreeEdges.size()) / nEdges << " at most\n";
+    }
+    std::bernoulli_distribution isBoegOnly(boegOnlyProbability);
+    edgeBoegFlags.assign(nEdges, 0);
+    for (const uint32_t e : nonTreeEdges) {
+        edgeBoegFlags[e] = isBoegOnly(prng);
+    }
+    
+    // Random subset of targets
+    std::vector<uint32_t> ids(nVertices);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(ids.begin(), ids.end(), prng);
+    const uint32_t nTargets = static_cast<uint32_t>(std::lround(options.targetFraction * nVertices));
+    for (uint32_t i = 0; i < nTargets; ++i) {
+        vertices[ids[i]].isTarget = 1;
+    }
+    
+    if (options.isShuffled) {
+        // Relabel vertices randomly (ids carry no locality)
+        std::shuffle(ids.begin(), ids.end(), prng);
+        std::vector<Vertex> shuffled(nVertices);
+        for (uint32_t v = 0; v < nVertices; ++v) {
+            shuffled[ids[v]] = std::move(vertices[v]);
+            shuffled[ids[v]].location = std::to_string(ids[v]);
+        }
+        vertices = std::move(shuffled);
+        for (uint32_t &v : edgeSources) v = ids[v];
+        for (uint32_t &v : edgeTargets) v = ids[v];
+    }
+    
+    return Graph(Graph::GRAPH_UNDIRECTED, std::move(vertices), edgeSources, edgeTargets, edgeBoegFlags);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    try {
+        const char *outputFile;
+        const GeneratorOptions options = parseOptions(argc, argv, outputFile);
+        
+        const auto start = std::chrono::steady_clock::now();
+        const Graph graph = generateBoard(options);
+        graph.writeBoard(outputFile);
+        const auto end = std::chrono::steady_clock::now();
+        
+        uint32_t nTargets = 0;
+        for (const Vertex &vert : graph.getVertices()) {
+            nTargets += vert.isTarget;
+        }
+        std::cout << "Generated " << outputFile << ": " << graph.getNVertices()
+                  << " vertices, " << graph.getNEdges() << " edges (mean degree "
+                  << 2.0 * graph.getNEdges() / graph.getNVertices() << "), "
+                  << nTargets << " targets in "
+                  << std::chrono::duration<double>(end - start).count() << " s\n";
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << '\n';
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <exception>
+#include <chrono>
+#include <filesystem>
+
+#include <fangpp/graph.hpp>
+
+// Computes screen positions of a board (e.g., a generated one) with the
+// force-directed layout of Graph::computeLayout() and writes them back to
+// the board file or to another file (format given by its extension)
+
+namespace {
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options] <board> [output]\n"
+              << "  -i <iterations>  number of simulation steps (default 100)\n"
+              << "  -j <threads>     number of threads (default: all hardware threads)\n"
+              << "  -t <theta>       Barnes-Hut opening criterion, 0 is exact (default 1)\n"
+              << "  -r               start from random positions\n"
+              << "  -s <seed>        random seed (default 1)\n"
+              << "Writes positions back to <board> unless [output] is given. Plain-text\n"
+              << "boards (.txt) do not store positions, so use .graphml or .fbrd output\n";
+}
+
+LayoutOptions parseOptions(const int argc, char *argv[], const char *&boardFile,
+    const char *&outputFile)
+{
+    LayoutOptions options;
+    boardFile = nullptr;
+    outputFile = nullptr;
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string
+        {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value of option " + arg);
+            return argv[++i];
+        };
+        
+        if (arg == "-i") {
+            options.nIterations = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-j") {
+            options.nThreads = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-t") {
+            options.theta = std::stof(value());
+        } else if (arg == "-r") {
+            options.isRandomStart = true;
+        } else if (arg == "-s") {
+            options.seed = static_cast<uint32_t>(std::stoul(value()));
+        } else if (!boardFile && arg[0] != '-') {
+            boardFile = argv[i];
+        } else if (!outputFile && arg[0] != '-') {
+            outputFile = argv[i];
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    
+    if (!boardFile) throw std::invalid_argument("Missing board file");
+    if (!outputFile) outputFile = boardFile;
+    if (std::filesystem::path(outputFile).extension() == ".txt") {
+        throw std::invalid_argument("Plain-text boards cannot store positions");
+    }
+    if (options.theta < 0.0f) throw std::invalid_argument("Theta must not be negative");
+    
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    try {
+        const char *boardFile, *outputFile;
+        const LayoutOptions options = parseOptions(argc, argv, boardFile, outputFile);
+        
+        Graph graph(boardFile);
+        
+        const auto start = std::chrono::steady_clock::now();
+        graph.computeLayout(options);
+        const auto end = std::chrono::steady_clock::now();
+        
+        graph.writeBoard(outputFile);
+        std::cout << "Laid out " << graph.getNVertices() << " vertices, "
+                  << graph.getNEdges() << " edges in "
+                  << std::chrono::duration<double>(end - start).count()
+                  << " s, written to " << outputFile << '\n';
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << '\n';
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
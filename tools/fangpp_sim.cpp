@@ -0,0 +1,198 @@
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <chrono>
+
+#include <fangpp/game_state.hpp>
+
+// Plays full games between computer players without graphics or sound and
+// reports how fast games are played and how each player fared, e.g., to
+// compare strategies or to profile the game logic
+
+namespace {
+
+struct SimOptions {
+    uint32_t nGames = 100;
+    uint32_t maxMoves = 100000;  // moves after which a game is abandoned
+    uint32_t seed = 42;
+    uint8_t nPlayers = 4;
+    uint8_t nTargetsPlayer = 4;
+    uint8_t nDice = 1;
+    std::vector<StrategyType> strategyTypes;  // per player (all avoidant if empty)
+    bool isVerbose = false;  // print moves
+};
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options] <board>\n"
+              << "  -n <games>       number of games (default 100)\n"
+              << "  -p <players>     number of players (default 4)\n"
+              << "  -t <targets>     number of targets per player (default 4)\n"
+              << "  -d <dice>        number of dice rolled per move (default 1)\n"
+              << "  -S <strategies>  comma-separated strategy per player, greedy or avoidant;\n"
+              << "                   a single strategy is used by all players (default avoidant)\n"
+              << "  -s <seed>        random seed (default 42)\n"
+              << "  -m <moves>       abandon games after <moves> moves (default 100000)\n"
+              << "  -v               print moves\n";
+}
+
+StrategyType parseStrategyType(const std::string &name)
+{
+    if (name == "greedy") return STRATEGY_GREEDY;
+    if (name == "avoidant") return STRATEGY_AVOIDANT;
+    
+    throw std::invalid_argument("Unknown strategy: " + name);
+}
+
+std::string strategyName(const StrategyType type)
+{
+    return (type == STRATEGY_GREEDY) ? "greedy" : "avoidant";
+}
+
+SimOptions parseOptions(const int argc, char *argv[], const char *&boardFile)
+{
+    SimOptions options;
+    boardFile = nullptr;
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string
+        {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value of option " + arg);
+            return argv[++i];
+        };
+        
+        if (arg == "-n") {
+            options.nGames = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-p") {
+            options.nPlayers = static_cast<uint8_t>(std::stoul(value()));
+        } else if (arg == "-t") {
+            options.nTargetsPlayer = static_cast<uint8_t>(std::stoul(value()));
+        } else if (arg == "-d") {
+            options.nDice = static_cast<uint8_t>(std::stoul(value()));
+        } else if (arg == "-S") {
+            std::stringstream names(value());
+            options.strategyTypes.clear();
+            for (std::string name; std::getline(names, name, ','); ) {
+                options.strategyTypes.push_back(parseStrategyType(name));
+            }
+        } else if (arg == "-s") {
+            options.seed = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-m") {
+            options.maxMoves = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "-v") {
+            options.isVerbose = true;
+        } else if (!boardFile && arg[0] != '-') {
+            boardFile = argv[i];
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    
+    if (!boardFile) throw std::invalid_argument("Missing board file");
+    
+    // Note: Player counts beyond the characters of the game are rejected,
+    //       as the game is meant to be shown eventually
+    if (options.nPlayers < 2 || options.nPlayers + 1u > Player::maxPlayableCharacters) {
+        throw std::invalid_argument("Require 2 to " +
+            std::to_string(Player::maxPlayableCharacters - 1) + " players");
+    }
+    
+    if (options.strategyTypes.empty()) {
+        options.strategyTypes.assign(options.nPlayers, STRATEGY_AVOIDANT);
+    } else if (options.strategyTypes.size() == 1) {
+        options.strategyTypes.assign(options.nPlayers, options.strategyTypes[0]);
+    } else if (options.strategyTypes.size() != options.nPlayers) {
+        throw std::invalid_argument("Require 1 strategy or 1 per player");
+    }
+    
+    return options;
+}
+
+// Outcome of a player over all games
+struct PlayerStats {
+    uint32_t nWins = 0;       // games finished first
+    uint64_t rankSum = 0;     // sum of finishing ranks (1: first)
+    uint32_t nFinished = 0;   // games finished at all
+};
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    try {
+        const char *boardFile;
+        const SimOptions options = parseOptions(argc, argv, boardFile);
+        
+        Game game(boardFile, options.nPlayers, options.nTargetsPlayer, options.nDice,
+            options.strategyTypes);
+        game.setMoveLogging(options.isVerbose);
+        const Graph &board = game.getBoard();
+        std::cout << boardFile << ": " << board.getNVertices() << " vertices, "
+                  << board.getNEdges() << " edges, " << board.getTargetVertices().size()
+                  << " targets\n";
+        
+        std::vector<PlayerStats> stats(options.nPlayers);
+        uint64_t nMoves = 0;
+        uint32_t nAbandoned = 0;
+        
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < options.nGames; ++i) {
+            game.seed(options.seed + i);
+            game.initializeState();
+            
+            uint32_t nGameMoves = 0;
+            uint32_t rank = 0;
+            while (!game.isGameOver() && nGameMoves < options.maxMoves) {
+                Player &player = game.getCurrentPlayer();
+                const Game::Status status = game.makeMove();
+                ++nGameMoves;
+                
+                if ((status & Game::TARGET_VISITED) && player.isFinished()) {
+                    PlayerStats &playerStats = stats[player.getId()];
+                    ++rank;
+                    playerStats.nWins += (rank == 1);
+                    playerStats.rankSum += rank;
+                    ++playerStats.nFinished;
+                }
+                game.prepareNextMove(status);
+            }
+            
+            nMoves += nGameMoves;
+            nAbandoned += !game.isGameOver();
+            if (options.isVerbose) {
+                std::cout << "Game " << i + 1 << ": " << nGameMoves << " moves\n";
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        
+        std::cout << options.nGames << " games (" << nAbandoned << " abandoned), "
+                  << nMoves << " moves in " << std::fixed << std::setprecision(3) << seconds << " s\n"
+                  << std::setprecision(1) << options.nGames / seconds << " games/s, "
+                  << nMoves / seconds << " moves/s, "
+                  << static_cast<double>(nMoves) / std::max(1u, options.nGames) << " moves/game\n";
+        
+        std::cout << "Player  strategy    wins  finished  mean rank\n";
+        for (uint8_t id = 0; id < options.nPlayers; ++id) {
+            const PlayerStats &playerStats = stats[id];
+            std::cout << std::setw(6) << static_cast<uint32_t>(id) << "  "
+                      << std::left << std::setw(10) << strategyName(options.strategyTypes[id]) << std::right
+                      << std::setw(6) << playerStats.nWins
+                      << std::setw(10) << playerStats.nFinished
+                      << std::setw(11) << std::setprecision(2)
+                      << ((playerStats.nFinished > 0) ?
+                          static_cast<double>(playerStats.rankSum) / playerStats.nFinished : 0.0)
+                      << '\n';
+        }
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << '\n';
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <chrono>
+#include <random>
+#include <filesystem>
+#include <cstring>
+#include <cmath>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fangpp/graph.hpp>
+
+// Measures the effect of vertex reordering on BFS over a large generated
+// board. Vertices are random points in the unit square connected to their
+// nearest neighbors, numbered randomly (as vertex ids of large board files
+// typically carry no locality). The board is loaded in file, BFS and reverse
+// Cuthill-McKee order and the same shortest path queries are run on each
+
+namespace {
+
+// Hardware cache miss counter of the calling thread (if available)
+class CacheMissCounter {
+public:
+    CacheMissCounter()
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    
+    CacheMissCounter(const CacheMissCounter &) = delete;
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+    
+    ~CacheMissCounter() { if (fd >= 0) close(fd); }
+    
+    bool isAvailable() const { return fd >= 0; }
+    
+    void start()
+    {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    
+    uint64_t stop()
+    {
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return 0;
+        
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Random geometric board: each vertex is connected to its 'degree' nearest
+// neighbors (found through a uniform grid). Returns edges as vertex pairs
+std::vector<std::pair<uint32_t,uint32_t>> generateBoard(const uint32_t nVertices,
+    const uint32_t degree, std::mt19937 &prng)
+{
+    std::uniform_real_distribution<float> coordinate(0.0f, 1.0f);
+    std::vector<float> xs(nVertices), ys(nVertices);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        xs[v] = coordinate(prng);
+        ys[v] = coordinate(prng);
+    }
+    
+    // About two vertices per grid cell
+    const uint32_t gridSize = std::max(1u, static_cast<uint32_t>(std::sqrt(nVertices / 2.0)));
+    const auto cellOf = [gridSize](const float c)
+    {
+        return std::min(gridSize - 1, static_cast<uint32_t>(c * gridSize));
+    };
+    std::vector<uint32_t> cellOffsets(gridSize * gridSize + 1, 0);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        cellOffsets[cellOf(ys[v]) * gridSize + cellOf(xs[v]) + 1] += 1;
+    }
+    std::inclusive_scan(cellOffsets.begin(), cellOffsets.end(), cellOffsets.begin());
+    std::vector<uint32_t> cellVertices(nVertices);
+    std::vector<uint32_t> fill(cellOffsets.begin(), cellOffsets.end() - 1);
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        cellVertices[fill[cellOf(ys[v]) * gridSize + cellOf(xs[v])]++] = v;
+    }
+    
+    std::vector<std::pair<uint32_t,uint32_t>> edges;
+    std::vector<std::pair<float,uint32_t>> candidates;
+    for (uint32_t v = 0; v < nVertices; ++v) {
+        const int cx = static_cast<int>(cellOf(xs[v]));
+        const int cy = static_cast<int>(cellOf(ys[v]));
+        
+        // Nearest neighbors among the surrounding 5 x 5 cells
+        candidates.clear();
+        for (int y = std::max(0, cy - 2); y <= std::min<int>(gridSize - 1, cy + 2); ++y) {
+            for (int x = std::max(0, cx - 2); x <= std::min<int>(gridSize - 1, cx + 2); ++x) {
+                const uint32_t cell = y * gridSize + x;
+                for (uint32_t i = cellOffsets[cell]; i < cellOffsets[cell + 1]; ++i) {
+                    const uint32_t n = cellVertices[i];
+                    if (n == v) continue;
+                    const float dx = xs[n] - xs[v], dy = ys[n] - ys[v];
+                    candidates.emplace_back(dx * dx + dy * dy, n);
+                }
+            }
+        }
+        
+        const std::size_t k = std::min<std::size_t>(degree, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+        for (std::size_t i = 0; i < k; ++i) {
+            const uint32_t n = candidates[i].second;
+            edges.emplace_back(std::min(v, n), std::max(v, n));
+        }
+    }
+    
+    // Mutual nearest neighbors would be connected twice
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    
+    return edges;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " [#vertices] [degree] [#queries]\n";
+        return EXIT_FAILURE;
+    }
+    
+    const uint32_t nVertices = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+    const uint32_t degree    = (argc > 2) ? std::stoul(argv[2]) : 4;
+    const uint32_t nQueries  = (argc > 3) ? std::stoul(argv[3]) : 20;
+    
+    try {
+        std::mt19937 prng(42);
+        const auto edges = generateBoard(nVertices, degree, prng);
+        
+        // Random file ids
+        std::vector<uint32_t> fileIds(nVertices);
+        std::iota(fileIds.begin(), fileIds.end(), 0);
+        std::shuffle(fileIds.begin(), fileIds.end(), prng);
+        
+        const auto boardPath = std::filesystem::temp_directory_path() / "fangpp_reorder_benchmark.txt";
+        {
+            std::ofstream out(boardPath);
+            out << "u\n" << nVertices << '\n';
+            for (const auto &[u, v] : edges) {
+                out << fileIds[u] << ' ' << fileIds[v] << '\n';
+            }
+            if (!out) throw std::runtime_error("Failed to write " + boardPath.string());
+        }
+        std::cout << "Board: " << nVertices << " vertices, " << edges.size() << " edges\n";
+        
+        std::vector<uint32_t> sources(nQueries);
+        std::uniform_int_distribution<uint32_t> vertexDist(0, nVertices - 1);
+        for (uint32_t &source : sources) source = vertexDist(prng);
+        
+        CacheMissCounter cacheMisses;
+        if (!cacheMisses.isAvailable()) {
+            std::cout << "Note: hardware cache miss counter not available\n";
+        }
+        
+        const std::pair<Graph::VERTEX_ORDER, const char *> orders[] = {
+            {Graph::ORDER_FILE, "file"}, {Graph::ORDER_BFS, "BFS"}, {Graph::ORDER_RCM, "RCM"}
+        };
+        std::cout << std::left << std::setw(6) << "order" << std::right
+                  << std::setw(12) << "load [ms]" << std::setw(16) << "avg |u - v|"
+                  << std::setw(14) << "BFS [ms]" << std::setw(18) << "misses/BFS"
+                  << std::setw(14) << "checksum" << '\n';
+        for (const auto &[order, name] : orders) {
+            const auto loadStart = std::chrono::steady_clock::now();
+            const Graph graph(boardPath.c_str(), order);
+            const auto loadEnd = std::chrono::steady_clock::now();
+            
+            // Average id distance of adjacent vertices
+            double span = 0.0;
+            for (const auto &[u, v] : edges) {
+                const int64_t a = graph.getInternalId(fileIds[u]);
+                const int64_t b = graph.getInternalId(fileIds[v]);
+                span += std::abs(a - b);
+            }
+            span /= std::max<std::size_t>(1, edges.size());
+            
+            // Same (physical) sources for every order
+            ScopedQuery query = graph.acquireQuery();
+            uint64_t checksum = 0;
+            uint64_t misses = 0;
+            double bfsTime = 0.0;
+            for (const uint32_t source : sources) {
+                const uint32_t internalSource = graph.getInternalId(fileIds[source]);
+                
+                const auto start = std::chrono::steady_clock::now();
+                cacheMisses.start();
+                graph.shortestPaths(internalSource, *query);
+                misses += cacheMisses.stop();
+                bfsTime += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+                
+                for (uint32_t v = 0; v < nVertices; ++v) {
+                    checksum += query->minDistance(v);
+                }
+            }
+            
+            std::cout << std::left << std::setw(6) << name << std::right << std::fixed
+                      << std::setprecision(1)
+                      << std::setw(12) << std::chrono::duration<double, std::milli>(loadEnd - loadStart).count()
+                      << std::setw(16) << span
+                      << std::setw(14) << bfsTime / nQueries;
+            if (cacheMisses.isAvailable()) {
+                std::cout << std::setw(18) << misses / nQueries;
+            } else {
+                std::cout << std::setw(18) << "n/a";
+            }
+            std::cout << std::setw(14) << checksum << '\n';
+        }
+        
+        std::filesystem::remove(boardPath);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}